@@ -86,7 +86,10 @@ namespace Prelude
 			public:
 				Template(const T &) {}
 				Template(Template *) {}
-				Template &operator =(Template *) {}
+				Template &operator =(Template *)
+				{
+					return *this;
+				}
 
 				Template *reference()
 				{
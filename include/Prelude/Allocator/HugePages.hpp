@@ -0,0 +1,112 @@
+#pragma once
+#include <stdint.h>
+#include "../Allocator.hpp"
+#include "../Internal/ChunkList.hpp"
+
+#ifdef WIN32
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+#endif
+
+namespace Prelude
+{
+	namespace Allocator
+	{
+		/*
+		 * Maps memory directly from the OS in multiples of the 2 MiB huge page size, aligned to it so that
+		 * transparent huge pages can back it. Meant for large chunks, like those of a Region using ChunkGrowth::HugePage.
+		 */
+		struct HugePageImplementation
+		{
+			static const size_t page_size = 0x200000;
+			static const size_t header = 16;
+
+			static void *map(size_t size)
+			{
+				#ifdef WIN32
+					void *result = VirtualAlloc(0, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+
+					prelude_runtime_assert(result != 0);
+
+					return result;
+				#else
+					uint8_t *result = (uint8_t *)mmap(0, size + page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+					prelude_runtime_assert(result != MAP_FAILED);
+
+					uint8_t *start = (uint8_t *)align((size_t)result, page_size);
+
+					if(start != result)
+						munmap(result, start - result);
+
+					munmap(start + size, (result + page_size) - start);
+
+					#ifdef MADV_HUGEPAGE
+						madvise(start, size, MADV_HUGEPAGE);
+					#endif
+
+					return start;
+				#endif
+			}
+
+			static void unmap(void *memory, size_t size)
+			{
+				#ifdef WIN32
+					VirtualFree(memory, 0, MEM_RELEASE);
+				#else
+					munmap(memory, size);
+				#endif
+			}
+
+			static void *allocate(size_t bytes)
+			{
+				size_t size = align(bytes + header, page_size);
+				size_t *result = (size_t *)map(size);
+
+				*result = size;
+
+				return (uint8_t *)result + header;
+			}
+
+			static void *reallocate(void *memory, size_t old_size, size_t bytes)
+			{
+				if(!memory)
+					return allocate(bytes);
+
+				size_t *start = (size_t *)((uint8_t *)memory - header);
+
+				if(bytes + header <= *start)
+					return memory;
+
+				void *result = allocate(bytes);
+
+				std::memcpy(result, memory, old_size);
+
+				free(memory);
+
+				return result;
+			}
+
+			static void free(void *memory)
+			{
+				if(!memory)
+					return;
+
+				size_t *start = (size_t *)((uint8_t *)memory - header);
+
+				unmap(start, *start);
+			}
+
+			static const bool can_free = true;
+			static const bool null_references = false;
+		};
+
+		typedef Template<HugePageImplementation> HugePages;
+	};
+
+	namespace ChunkGrowth
+	{
+		typedef Fixed<Allocator::HugePageImplementation::page_size - Allocator::HugePageImplementation::header> HugePage;
+	};
+};
@@ -0,0 +1,258 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <ostream>
+#include "../Allocator.hpp"
+
+namespace Prelude
+{
+	namespace Allocator
+	{
+		template<int dummy = 0> struct TagState
+		{
+			static prelude_thread const char *current;
+		};
+
+		template<int dummy> prelude_thread const char *TagState<dummy>::current = 0;
+
+		/*
+		 * Attributes allocations made by this thread to name until the tag goes out of scope.
+		 */
+		class Tag
+		{
+			private:
+				const char *previous;
+
+			public:
+				Tag(const char *name) : previous(TagState<>::current)
+				{
+					TagState<>::current = name;
+				}
+
+				~Tag()
+				{
+					TagState<>::current = previous;
+				}
+		};
+
+		/*
+		 * Counters kept by the Tracing allocators. Each block gets a header with its size and tag,
+		 * so frees can be accounted without the caller passing the size.
+		 */
+		class Statistics
+		{
+			public:
+				static const size_t header = 16;
+				static const size_t classes = 32;
+				static const size_t max_tags = 32;
+
+				struct Counter
+				{
+					std::atomic<size_t> allocations;
+					std::atomic<size_t> live;
+					std::atomic<size_t> peak;
+
+					Counter() : allocations(0), live(0), peak(0) {}
+
+					void add(size_t bytes)
+					{
+						size_t now = live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+						size_t max = peak.load(std::memory_order_relaxed);
+
+						while(now > max && !peak.compare_exchange_weak(max, now, std::memory_order_relaxed));
+					}
+
+					void remove(size_t bytes)
+					{
+						live.fetch_sub(bytes, std::memory_order_relaxed);
+					}
+				};
+
+				Counter total;
+				std::atomic<size_t> reallocations;
+				std::atomic<size_t> frees;
+				std::atomic<size_t> histogram[classes];
+				std::atomic<const char *> tags[max_tags];
+				Counter tag_counters[max_tags + 1];
+
+				Statistics() : reallocations(0), frees(0)
+				{
+					for(size_t i = 0; i < classes; ++i)
+						histogram[i].store(0, std::memory_order_relaxed);
+
+					for(size_t i = 0; i < max_tags; ++i)
+						tags[i].store(0, std::memory_order_relaxed);
+				}
+
+				static size_t size_class(size_t bytes)
+				{
+					size_t result = 0;
+
+					while(((size_t)1 << result) < bytes && result < classes - 1)
+						result++;
+
+					return result;
+				}
+
+				size_t tag_index(const char *tag)
+				{
+					if(!tag)
+						return max_tags;
+
+					for(size_t i = 0; i < max_tags; ++i)
+					{
+						const char *name = tags[i].load(std::memory_order_acquire);
+
+						if(!name && tags[i].compare_exchange_strong(name, tag, std::memory_order_acq_rel))
+							return i;
+
+						if(name == tag)
+							return i;
+					}
+
+					return max_tags;
+				}
+
+				void *track(void *block, size_t bytes)
+				{
+					size_t *start = (size_t *)block;
+					size_t tag = tag_index(TagState<>::current);
+
+					start[0] = bytes;
+					start[1] = tag;
+
+					total.allocations.fetch_add(1, std::memory_order_relaxed);
+					total.add(bytes);
+					tag_counters[tag].allocations.fetch_add(1, std::memory_order_relaxed);
+					tag_counters[tag].add(bytes);
+					histogram[size_class(bytes)].fetch_add(1, std::memory_order_relaxed);
+
+					return (uint8_t *)block + header;
+				}
+
+				void *untrack(void *memory)
+				{
+					size_t *start = (size_t *)((uint8_t *)memory - header);
+
+					total.remove(start[0]);
+					tag_counters[start[1]].remove(start[0]);
+
+					return start;
+				}
+
+				void *retrack(void *block, size_t bytes)
+				{
+					size_t *start = (size_t *)block;
+
+					reallocations.fetch_add(1, std::memory_order_relaxed);
+					total.add(bytes);
+					tag_counters[start[1]].add(bytes);
+					histogram[size_class(bytes)].fetch_add(1, std::memory_order_relaxed);
+
+					start[0] = bytes;
+
+					return (uint8_t *)block + header;
+				}
+
+				void dump(std::ostream &stream)
+				{
+					stream << "allocations: " << total.allocations.load() << ", reallocations: " << reallocations.load() << ", frees: " << frees.load() << std::endl;
+					stream << "live bytes: " << total.live.load() << ", peak bytes: " << total.peak.load() << std::endl;
+
+					for(size_t i = 0; i < classes; ++i)
+					{
+						size_t count = histogram[i].load();
+
+						if(count)
+							stream << "  <= " << ((size_t)1 << i) << " bytes: " << count << std::endl;
+					}
+
+					for(size_t i = 0; i <= max_tags; ++i)
+					{
+						Counter &counter = tag_counters[i];
+
+						if(!counter.allocations.load())
+							continue;
+
+						const char *name = i < max_tags ? tags[i].load() : "(untagged)";
+
+						stream << "  " << name << ": " << counter.allocations.load() << " allocations, " << counter.live.load() << " live bytes, " << counter.peak.load() << " peak bytes" << std::endl;
+					}
+				}
+		};
+
+		template<class Implementation> struct TracingImplementation
+		{
+			static Statistics statistics;
+
+			static void *allocate(size_t bytes)
+			{
+				return statistics.track(Implementation::allocate(bytes + Statistics::header), bytes);
+			}
+
+			static void *reallocate(void *memory, size_t old_size, size_t bytes)
+			{
+				if(!memory)
+					return allocate(bytes);
+
+				void *start = statistics.untrack(memory);
+
+				return statistics.retrack(Implementation::reallocate(start, old_size + Statistics::header, bytes + Statistics::header), bytes);
+			}
+
+			static void free(void *memory)
+			{
+				if(!memory)
+					return;
+
+				statistics.frees.fetch_add(1, std::memory_order_relaxed);
+
+				Implementation::free(statistics.untrack(memory));
+			}
+
+			static const bool can_free = Implementation::can_free;
+			static const bool null_references = Implementation::null_references;
+		};
+
+		template<class Implementation> Statistics TracingImplementation<Implementation>::statistics;
+
+		template<class BaseAllocator = Standard> class Tracing
+		{
+			private:
+				BaseAllocator allocator;
+
+			public:
+				Statistics statistics;
+
+				Tracing(typename BaseAllocator::Reference allocator = BaseAllocator::default_reference) : allocator(allocator) {}
+
+				void *allocate(size_t bytes)
+				{
+					return statistics.track(allocator.allocate(bytes + Statistics::header), bytes);
+				}
+
+				void *reallocate(void *memory, size_t old_size, size_t bytes)
+				{
+					if(!memory)
+						return allocate(bytes);
+
+					void *start = statistics.untrack(memory);
+
+					return statistics.retrack(allocator.reallocate(start, old_size + Statistics::header, bytes + Statistics::header), bytes);
+				}
+
+				void free(void *memory)
+				{
+					if(!memory)
+						return;
+
+					statistics.frees.fetch_add(1, std::memory_order_relaxed);
+
+					allocator.free(statistics.untrack(memory));
+				}
+
+				static const bool can_free = BaseAllocator::can_free;
+				static const bool null_references = BaseAllocator::null_references;
+		};
+	};
+};
@@ -0,0 +1,232 @@
+#pragma once
+#include <stdint.h>
+#include <mutex>
+#include "../Allocator.hpp"
+
+namespace Prelude
+{
+	namespace Allocator
+	{
+		/*
+		 * Size class allocator with a free list per class and thread. Threads move blocks to and from a shared pool
+		 * in batches, so the pool lock is only taken once per batch. Memory for the small classes is carved from slabs
+		 * which are never returned to Backing. flush() may pool a short batch, so refill() counts the batch it takes.
+		 * Blocks cached by a thread are lost when it exits, unless it calls flush() first.
+		 */
+		template<class Backing = StandardImplementation> struct ThreadCacheImplementation
+		{
+			static const size_t classes = 14;
+			static const size_t header = memory_align;
+			static const size_t max_size = 0x2000;
+
+			struct Block
+			{
+				Block *next;
+				Block *next_batch;
+			};
+
+			struct Pool
+			{
+				std::mutex lock;
+				Block *batches;
+			};
+
+			static Pool pool[classes];
+			static prelude_thread Block *cache[classes];
+			static prelude_thread size_t cached[classes];
+
+			static size_t size_class(size_t bytes)
+			{
+				if(bytes <= 128)
+					return (bytes + 15) / 16 - 1;
+
+				size_t result = 8;
+
+				for(size_t size = 256; size < bytes; size <<= 1)
+					result++;
+
+				return result;
+			}
+
+			static size_t class_size(size_t index)
+			{
+				if(index < 8)
+					return (index + 1) * 16;
+
+				return (size_t)256 << (index - 8);
+			}
+
+			static size_t batch_size(size_t index)
+			{
+				size_t result = 0x4000 / class_size(index);
+
+				return result < 2 ? 2 : (result > 64 ? 64 : result);
+			}
+
+			static void refill(size_t index)
+			{
+				size_t batch = batch_size(index);
+
+				Block *result;
+
+				{
+					std::lock_guard<std::mutex> guard(pool[index].lock);
+
+					result = pool[index].batches;
+
+					if(result)
+						pool[index].batches = result->next_batch;
+				}
+
+				if(result)
+				{
+					size_t count = 0;
+
+					for(Block *block = result; block; block = block->next)
+						count++;
+
+					cache[index] = result;
+					cached[index] = count;
+					return;
+				}
+
+				size_t size = class_size(index);
+				uint8_t *slab = (uint8_t *)Backing::allocate(size * batch);
+				Block *list = nullptr;
+
+				for(size_t i = batch; i-- > 0;)
+				{
+					Block *block = (Block *)(slab + i * size);
+
+					block->next = list;
+					list = block;
+				}
+
+				cache[index] = list;
+				cached[index] = batch;
+			}
+
+			static void release(size_t index, size_t count)
+			{
+				Block *first = cache[index];
+				Block *last = first;
+
+				for(size_t i = 1; i < count; ++i)
+					last = last->next;
+
+				cache[index] = last->next;
+				cached[index] -= count;
+
+				last->next = nullptr;
+
+				std::lock_guard<std::mutex> guard(pool[index].lock);
+
+				first->next_batch = pool[index].batches;
+				pool[index].batches = first;
+			}
+
+			static void flush()
+			{
+				for(size_t i = 0; i < classes; ++i)
+				{
+					size_t batch = batch_size(i);
+
+					while(cached[i] >= batch)
+						release(i, batch);
+
+					if(cached[i])
+						release(i, cached[i]);
+				}
+			}
+
+			static void *allocate(size_t bytes)
+			{
+				size_t total = bytes + header;
+
+				if(prelude_unlikely(total > max_size))
+				{
+					size_t *result = (size_t *)Backing::allocate(total);
+
+					*result = classes;
+
+					return (uint8_t *)result + header;
+				}
+
+				size_t index = size_class(total);
+
+				if(prelude_unlikely(!cache[index]))
+					refill(index);
+
+				Block *block = cache[index];
+
+				cache[index] = block->next;
+				cached[index]--;
+
+				*(size_t *)block = index;
+
+				return (uint8_t *)block + header;
+			}
+
+			static void free(void *memory)
+			{
+				if(!memory)
+					return;
+
+				size_t *start = (size_t *)((uint8_t *)memory - header);
+				size_t index = *start;
+
+				if(prelude_unlikely(index == classes))
+				{
+					Backing::free(start);
+					return;
+				}
+
+				Block *block = (Block *)start;
+
+				block->next = cache[index];
+				cache[index] = block;
+				cached[index]++;
+
+				size_t batch = batch_size(index);
+
+				if(prelude_unlikely(cached[index] > batch * 2))
+					release(index, batch);
+			}
+
+			static void *reallocate(void *memory, size_t old_size, size_t bytes)
+			{
+				if(!memory)
+					return allocate(bytes);
+
+				size_t *start = (size_t *)((uint8_t *)memory - header);
+				size_t index = *start;
+				size_t total = bytes + header;
+
+				if(index == classes)
+				{
+					if(total > max_size)
+						return (uint8_t *)Backing::reallocate(start, old_size + header, total) + header;
+				}
+				else if(total <= class_size(index))
+					return memory;
+
+				void *result = allocate(bytes);
+
+				std::memcpy(result, memory, old_size < bytes ? old_size : bytes);
+
+				free(memory);
+
+				return result;
+			}
+
+			static const bool can_free = true;
+			static const bool null_references = false;
+		};
+
+		template<class Backing> typename ThreadCacheImplementation<Backing>::Pool ThreadCacheImplementation<Backing>::pool[ThreadCacheImplementation<Backing>::classes];
+		template<class Backing> prelude_thread typename ThreadCacheImplementation<Backing>::Block *ThreadCacheImplementation<Backing>::cache[ThreadCacheImplementation<Backing>::classes];
+		template<class Backing> prelude_thread size_t ThreadCacheImplementation<Backing>::cached[ThreadCacheImplementation<Backing>::classes];
+
+		typedef Template<ThreadCacheImplementation<> > ThreadCache;
+	};
+};
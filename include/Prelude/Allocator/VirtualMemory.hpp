@@ -0,0 +1,144 @@
+#pragma once
+#include <stdint.h>
+#include "../Allocator.hpp"
+
+#ifdef WIN32
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+#endif
+
+namespace Prelude
+{
+	namespace Allocator
+	{
+		/*
+		 * Every allocation reserves reserve_size bytes of address space and commits only what is in use,
+		 * so reallocate() never moves a block smaller than the reservation. Shrinking returns the unused pages to the OS.
+		 * Meant for a few very large tables, not for many small allocations.
+		 */
+		template<size_t reserve_size = (sizeof(void *) >= 8 ? (size_t)1 << 36 : (size_t)1 << 28)> struct VirtualMemoryImplementation
+		{
+			static const size_t granularity = 0x10000;
+
+			struct Header
+			{
+				size_t reserved;
+				size_t committed;
+			};
+
+			static uint8_t *reserve(size_t size)
+			{
+				#ifdef WIN32
+					void *result = VirtualAlloc(0, size, MEM_RESERVE, PAGE_NOACCESS);
+
+					prelude_runtime_assert(result != 0);
+				#else
+					void *result = mmap(0, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+					prelude_runtime_assert(result != MAP_FAILED);
+				#endif
+
+				return (uint8_t *)result;
+			}
+
+			static void commit(uint8_t *start, size_t size)
+			{
+				#ifdef WIN32
+					void *result = VirtualAlloc(start, size, MEM_COMMIT, PAGE_READWRITE);
+
+					prelude_runtime_assert(result != 0);
+				#else
+					int result = mprotect(start, size, PROT_READ | PROT_WRITE);
+
+					prelude_runtime_assert(result == 0);
+				#endif
+			}
+
+			static void decommit(uint8_t *start, size_t size)
+			{
+				#ifdef WIN32
+					VirtualFree(start, size, MEM_DECOMMIT);
+				#else
+					madvise(start, size, MADV_DONTNEED);
+					mprotect(start, size, PROT_NONE);
+				#endif
+			}
+
+			static void resize(Header *header, size_t bytes)
+			{
+				size_t committed = align(bytes + sizeof(Header), granularity);
+
+				if(committed > header->committed)
+					commit((uint8_t *)header + header->committed, committed - header->committed);
+				else if(committed < header->committed)
+					decommit((uint8_t *)header + committed, header->committed - committed);
+
+				header->committed = committed;
+			}
+
+			static void *allocate(size_t bytes)
+			{
+				size_t reserved = align(bytes + sizeof(Header), granularity);
+
+				if(reserved < reserve_size)
+					reserved = reserve_size;
+
+				uint8_t *start = reserve(reserved);
+
+				commit(start, granularity);
+
+				Header *header = (Header *)start;
+
+				header->reserved = reserved;
+				header->committed = granularity;
+
+				resize(header, bytes);
+
+				return header + 1;
+			}
+
+			static void *reallocate(void *memory, size_t old_size, size_t bytes)
+			{
+				if(!memory)
+					return allocate(bytes);
+
+				Header *header = (Header *)memory - 1;
+
+				if(prelude_likely(bytes + sizeof(Header) <= header->reserved))
+				{
+					resize(header, bytes);
+
+					return memory;
+				}
+
+				void *result = allocate(bytes);
+
+				std::memcpy(result, memory, old_size);
+
+				free(memory);
+
+				return result;
+			}
+
+			static void free(void *memory)
+			{
+				if(!memory)
+					return;
+
+				Header *header = (Header *)memory - 1;
+
+				#ifdef WIN32
+					VirtualFree(header, 0, MEM_RELEASE);
+				#else
+					munmap(header, header->reserved);
+				#endif
+			}
+
+			static const bool can_free = true;
+			static const bool null_references = false;
+		};
+
+		typedef Template<VirtualMemoryImplementation<> > VirtualMemory;
+	};
+};
@@ -0,0 +1,390 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "Internal/Common.hpp"
+#include "Allocator.hpp"
+#include "HashTable.hpp"
+
+namespace Prelude
+{
+	/*
+	 * HashTable variant which can be shared between threads. Readers take no locks, writers lock a stripe of buckets.
+	 * T::set_value_next must be a single word store, since readers may follow a link while a writer replaces it.
+	 * Bucket arrays replaced by expand() are kept until collect() is called or the table is destroyed.
+	 * Readers register in the current epoch on their hash's stripe. collect() advances the epoch and waits for the readers of
+	 * the previous one to leave before freeing anything. Since the table doubles the retired arrays never add up to more than the live array.
+	 */
+	template<class K, class V, class T, class BaseAllocator = Allocator::Standard> class ConcurrentHashTable
+	{
+		private:
+			static const size_t stripes = 64;
+
+			struct Buckets
+			{
+				size_t mask;
+				Buckets *retired;
+
+				std::atomic<V> &operator [](size_t index)
+				{
+					return ((std::atomic<V> *)(this + 1))[index];
+				}
+			};
+
+			prelude_align(struct, Stripe, 64)
+			{
+				std::mutex lock;
+				std::atomic<size_t> readers[2];
+			};
+
+			BaseAllocator allocator;
+			std::atomic<Buckets *> buckets;
+			std::atomic<size_t> version;
+			std::atomic<size_t> entries;
+			std::atomic<size_t> epoch;
+			Buckets *retired;
+			Stripe stripe_locks[stripes];
+
+			Buckets *allocate_buckets(size_t size)
+			{
+				Buckets *result = new (allocator.allocate(sizeof(Buckets) + size * sizeof(std::atomic<V>))) Buckets;
+
+				result->mask = size - 1;
+				result->retired = nullptr;
+
+				for(size_t i = 0; i < size; ++i)
+					new (&(*result)[i]) std::atomic<V>(T::invalid_value());
+
+				return result;
+			}
+
+			std::mutex &stripe(size_t hash)
+			{
+				return stripe_locks[hash & (stripes - 1)].lock;
+			}
+
+			void lock_all()
+			{
+				for(size_t i = 0; i < stripes; ++i)
+					stripe_locks[i].lock.lock();
+			}
+
+			void unlock_all()
+			{
+				for(size_t i = stripes; i-- > 0;)
+					stripe_locks[i].lock.unlock();
+			}
+
+			V find(Buckets *buckets, K key, size_t hash)
+			{
+				V entry = (*buckets)[hash & buckets->mask].load(std::memory_order_acquire);
+
+				while(T::valid_value(entry))
+				{
+					T::verify_value(entry);
+
+					if(T::compare_key(key, T::get_key(entry)))
+						return entry;
+
+					entry = T::get_value_next(entry);
+
+					std::atomic_thread_fence(std::memory_order_acquire);
+				}
+
+				return T::invalid_value();
+			}
+
+			std::atomic<size_t> &enter(size_t hash)
+			{
+				Stripe &reader = stripe_locks[hash & (stripes - 1)];
+
+				while(true)
+				{
+					size_t current = epoch.load(std::memory_order_seq_cst);
+					std::atomic<size_t> &result = reader.readers[current & 1];
+
+					result.fetch_add(1, std::memory_order_seq_cst);
+
+					if(prelude_likely(epoch.load(std::memory_order_seq_cst) == current))
+						return result;
+
+					result.fetch_sub(1, std::memory_order_release);
+				}
+			}
+
+			V lookup(K key, size_t hash)
+			{
+				std::atomic<size_t> &readers = enter(hash);
+				V result = search(key, hash);
+
+				readers.fetch_sub(1, std::memory_order_release);
+
+				return result;
+			}
+
+			V search(K key, size_t hash)
+			{
+				while(true)
+				{
+					size_t start = version.load(std::memory_order_acquire);
+
+					V result = find(buckets.load(std::memory_order_acquire), key, hash);
+
+					if(T::valid_value(result))
+						return result;
+
+					std::atomic_thread_fence(std::memory_order_acquire);
+
+					if(prelude_likely(!(start & 1) && version.load(std::memory_order_relaxed) == start))
+						return T::invalid_value();
+
+					std::this_thread::yield();
+				}
+			}
+
+			void expand(Buckets *seen)
+			{
+				lock_all();
+
+				Buckets *old = buckets.load(std::memory_order_relaxed);
+
+				if(old == seen)
+				{
+					size_t start = version.load(std::memory_order_relaxed);
+
+					version.store(start + 1, std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_release);
+
+					Buckets *table = allocate_buckets((old->mask + 1) << 1);
+
+					for(size_t i = 0; i <= old->mask; ++i)
+					{
+						V entry = (*old)[i].load(std::memory_order_relaxed);
+
+						while(T::valid_value(entry))
+						{
+							T::verify_value(entry);
+
+							V next = T::get_value_next(entry);
+							std::atomic<V> &slot = (*table)[T::hash_key(T::get_key(entry)) & table->mask];
+
+							T::set_value_next(entry, slot.load(std::memory_order_relaxed));
+							slot.store(entry, std::memory_order_relaxed);
+
+							entry = next;
+						}
+					}
+
+					buckets.store(table, std::memory_order_release);
+
+					old->retired = retired;
+					retired = old;
+
+					version.store(start + 2, std::memory_order_release);
+				}
+
+				unlock_all();
+			}
+
+			bool insert(K key, size_t hash, V &value, bool replace)
+			{
+				Buckets *table;
+				size_t mask;
+
+				{
+					std::lock_guard<std::mutex> guard(stripe(hash));
+
+					table = buckets.load(std::memory_order_relaxed);
+					mask = table->mask;
+
+					std::atomic<V> &slot = (*table)[hash & table->mask];
+					V entry = slot.load(std::memory_order_relaxed);
+					V tail = T::invalid_value();
+
+					while(T::valid_value(entry))
+					{
+						T::verify_value(entry);
+
+						if(T::compare_key(key, T::get_key(entry)))
+						{
+							if(!replace)
+							{
+								value = entry;
+								return true;
+							}
+
+							T::set_value_next(value, T::get_value_next(entry));
+
+							std::atomic_thread_fence(std::memory_order_release);
+
+							if(T::valid_value(tail))
+								T::set_value_next(tail, value);
+							else
+								slot.store(value, std::memory_order_release);
+
+							return true;
+						}
+
+						tail = entry;
+						entry = T::get_value_next(entry);
+					}
+
+					if(!T::valid_value(value))
+						value = T::create_value(get_allocator(), key, hash);
+
+					T::verify_value(value);
+
+					T::set_value_next(value, slot.load(std::memory_order_relaxed));
+					slot.store(value, std::memory_order_release);
+				}
+
+				if(prelude_unlikely(entries.fetch_add(1, std::memory_order_relaxed) + 1 > mask))
+					expand(table);
+
+				return false;
+			}
+
+			void free_buckets(Buckets *table)
+			{
+				allocator.free((void *)table);
+			}
+
+			template<typename F> void each_locked(F func)
+			{
+				Buckets *table = buckets.load(std::memory_order_relaxed);
+
+				for(size_t i = 0; i <= table->mask; ++i)
+				{
+					V entry = (*table)[i].load(std::memory_order_relaxed);
+
+					while(T::valid_value(entry))
+					{
+						T::verify_value(entry);
+
+						V next = T::get_value_next(entry);
+
+						func(entry);
+
+						entry = next;
+					}
+				}
+			}
+
+		public:
+			ConcurrentHashTable(size_t initial, typename BaseAllocator::Reference allocator = BaseAllocator::default_reference) : allocator(allocator), version(0), entries(0), epoch(0), retired(nullptr)
+			{
+				for(size_t i = 0; i < stripes; ++i)
+				{
+					stripe_locks[i].readers[0].store(0, std::memory_order_relaxed);
+					stripe_locks[i].readers[1].store(0, std::memory_order_relaxed);
+				}
+
+				size_t size = (size_t)1 << initial;
+
+				if(size < stripes)
+					size = stripes;
+
+				buckets.store(allocate_buckets(size), std::memory_order_relaxed);
+			}
+
+			~ConcurrentHashTable()
+			{
+				if(BaseAllocator::can_free)
+				{
+					each_locked([&](V entry) {
+						T::free_value(get_allocator(), entry);
+					});
+
+					collect();
+
+					free_buckets(buckets.load(std::memory_order_relaxed));
+				}
+			}
+
+			void collect()
+			{
+				lock_all();
+
+				Buckets *table = retired;
+
+				retired = nullptr;
+
+				size_t previous = epoch.fetch_add(1, std::memory_order_seq_cst) & 1;
+
+				for(size_t i = 0; i < stripes; ++i)
+					while(stripe_locks[i].readers[previous].load(std::memory_order_acquire))
+						std::this_thread::yield();
+
+				unlock_all();
+
+				while(table)
+				{
+					Buckets *next = table->retired;
+
+					free_buckets(table);
+
+					table = next;
+				}
+			}
+
+			template<typename F> void mark_content(F mark)
+			{
+				lock_all();
+
+				each_locked([&](V entry) {
+					T::mark_value(entry, mark);
+				});
+
+				unlock_all();
+			}
+
+			V get(K key)
+			{
+				if(prelude_unlikely(!T::valid_key(key)))
+					return T::invalid_value();
+
+				size_t hash = T::hash_key(key);
+				V result = lookup(key, hash);
+
+				if(T::valid_value(result) || !T::create_value())
+					return result;
+
+				result = T::invalid_value();
+
+				insert(key, hash, result, false);
+
+				return result;
+			}
+
+			size_t get_entries()
+			{
+				return entries.load(std::memory_order_relaxed);
+			}
+
+			bool has(K key)
+			{
+				return T::valid_value(lookup(key, T::hash_key(key)));
+			}
+
+			bool set(K key, V value)
+			{
+				T::verify_value(value);
+
+				return insert(key, T::hash_key(key), value, true);
+			}
+
+			template<typename F> void each_value(F func)
+			{
+				lock_all();
+
+				each_locked(func);
+
+				unlock_all();
+			}
+
+			typename BaseAllocator::Reference get_allocator()
+			{
+				return allocator.reference();
+			}
+	};
+};
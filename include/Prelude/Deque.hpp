@@ -0,0 +1,431 @@
+#pragma once
+#include <algorithm>
+#include "Vector.hpp"
+
+namespace Prelude
+{
+	/*
+	 * Ring buffer with amortized O(1) push and pop at both ends. The capacity is a power of two,
+	 * so the elements occupy at most two contiguous segments of the table.
+	 */
+	template<class T, class BaseAllocator = Allocator::Standard, template<class, class> class ArrayWrapper = Allocator::Array> class Deque
+	{
+		protected:
+			typedef ArrayWrapper<T, BaseAllocator> Allocator;
+
+			typename Allocator::Storage table;
+			Allocator allocator;
+			size_t head;
+			size_t _size;
+			size_t _capacity;
+
+			size_t wrap(size_t index) const
+			{
+				return index & (_capacity - 1);
+			}
+
+			size_t slot(size_t index) const
+			{
+				return wrap(head + index);
+			}
+
+			static void move_entries(T *to, T *from, size_t count)
+			{
+				if(TriviallyRelocatable<T>::value)
+					std::memcpy((void *)to, (void *)from, sizeof(T) * count);
+				else
+					for(size_t i = 0; i < count; ++i)
+					{
+						new (&to[i]) T(std::move(from[i]));
+						from[i].~T();
+					}
+			}
+
+			void release()
+			{
+				if(table)
+				{
+					if(!std::is_trivially_destructible<T>::value)
+						segments([&](T *start, size_t count) -> bool {
+							for(size_t i = 0; i < count; ++i)
+								start[i].~T();
+
+							return true;
+						});
+
+					allocator.free(table);
+				}
+			}
+
+			void reset()
+			{
+				table = nullptr;
+				head = 0;
+				_size = 0;
+				_capacity = 0;
+			}
+
+			void initialize_copy(const Deque &other)
+			{
+				reset();
+
+				expand(other._size);
+
+				other.segments([&](T *start, size_t count) -> bool {
+					for(size_t i = 0; i < count; ++i)
+						new (&table[_size++]) T(start[i]);
+
+					return true;
+				});
+			}
+
+		public:
+			Deque(typename Allocator::Reference allocator = Allocator::default_reference) : allocator(allocator)
+			{
+				reset();
+			}
+
+			Deque(Deque &&deque) :
+				table(deque.table),
+				allocator(deque.allocator),
+				head(deque.head),
+				_size(deque._size),
+				_capacity(deque._capacity)
+			{
+				deque.reset();
+			}
+
+			Deque(const Deque &deque) : allocator(deque.allocator)
+			{
+				initialize_copy(deque);
+			}
+
+			~Deque()
+			{
+				release();
+			}
+
+			Deque &operator=(const Deque &other)
+			{
+				if(this == &other)
+					return *this;
+
+				release();
+
+				initialize_copy(other);
+
+				return *this;
+			}
+
+			Deque &operator=(Deque &&other)
+			{
+				if(this == &other)
+					return *this;
+
+				release();
+
+				table = other.table;
+				allocator = other.allocator.reference();
+				head = other.head;
+				_size = other._size;
+				_capacity = other._capacity;
+
+				other.reset();
+
+				return *this;
+			}
+
+			void expand(size_t num)
+			{
+				if(prelude_likely(_size + num <= _capacity))
+					return;
+
+				size_t capacity = _capacity ? _capacity : 1;
+
+				while(_size + num > capacity)
+					capacity <<= 1;
+
+				if(table && TriviallyRelocatable<T>::value)
+				{
+					table = allocator.reallocate(table, _capacity, capacity);
+
+					size_t front = _capacity - head;
+
+					if(front < _size)
+						move_entries(&table[_capacity], &table[0], _size - front);
+				}
+				else
+				{
+					typename Allocator::Storage next = allocator.allocate(capacity);
+					size_t position = 0;
+
+					segments([&](T *start, size_t count) -> bool {
+						move_entries(&next[position], start, count);
+						position += count;
+
+						return true;
+					});
+
+					if(table)
+						allocator.free(table);
+
+					table = next;
+					head = 0;
+				}
+
+				_capacity = capacity;
+			}
+
+			template<typename F> void mark_content(F mark)
+			{
+				for(size_t i = 0; i < _size; ++i)
+					mark(table[slot(i)]);
+			}
+
+			template<typename F> void mark(F mark)
+			{
+				if(table)
+					mark(table);
+			}
+
+			size_t size() const
+			{
+				return _size;
+			}
+
+			size_t capacity() const
+			{
+				return _capacity;
+			}
+
+			T &first()
+			{
+				prelude_debug_assert(_size > 0);
+
+				return table[head];
+			}
+
+			T &last()
+			{
+				prelude_debug_assert(_size > 0);
+
+				return table[slot(_size - 1)];
+			}
+
+			T &operator [](size_t index)
+			{
+				prelude_debug_assert(index < _size);
+
+				return table[slot(index)];
+			}
+
+			const T &operator [](size_t index) const
+			{
+				prelude_debug_assert(index < _size);
+
+				return table[slot(index)];
+			}
+
+			void clear()
+			{
+				release();
+				reset();
+			}
+
+			void push(T entry)
+			{
+				expand(1);
+
+				new (&table[slot(_size)]) T(std::move(entry));
+
+				_size++;
+			}
+
+			void push_front(T entry)
+			{
+				expand(1);
+
+				head = wrap(head - 1);
+
+				new (&table[head]) T(std::move(entry));
+
+				_size++;
+			}
+
+			template<typename... Args> T &emplace(Args&&... args)
+			{
+				expand(1);
+
+				T *result = new (&table[slot(_size)]) T(std::forward<Args>(args)...);
+
+				_size++;
+
+				return *result;
+			}
+
+			template<typename... Args> T &emplace_front(Args&&... args)
+			{
+				expand(1);
+
+				head = wrap(head - 1);
+
+				T *result = new (&table[head]) T(std::forward<Args>(args)...);
+
+				_size++;
+
+				return *result;
+			}
+
+			void push_entries(T *entries, size_t count)
+			{
+				expand(count);
+
+				size_t start = slot(_size);
+				size_t front = std::min(count, _capacity - start);
+
+				if(std::is_trivially_copyable<T>::value)
+				{
+					std::memcpy((void *)&table[start], (void *)entries, sizeof(T) * front);
+					std::memcpy((void *)&table[0], (void *)(entries + front), sizeof(T) * (count - front));
+				}
+				else
+				{
+					for(size_t i = 0; i < front; ++i)
+						new (&table[start + i]) T(entries[i]);
+
+					for(size_t i = front; i < count; ++i)
+						new (&table[i - front]) T(entries[i]);
+				}
+
+				_size += count;
+			}
+
+			T pop()
+			{
+				prelude_debug_assert(_size);
+
+				_size -= 1;
+
+				T &entry = table[slot(_size)];
+				T result = std::move(entry);
+
+				entry.~T();
+				allocator.null(entry);
+
+				return result;
+			}
+
+			T shift()
+			{
+				prelude_debug_assert(_size);
+
+				T &entry = table[head];
+				T result = std::move(entry);
+
+				entry.~T();
+				allocator.null(entry);
+
+				head = wrap(head + 1);
+				_size -= 1;
+
+				return result;
+			}
+
+			template<typename F> bool segments(F func) const
+			{
+				if(!_size)
+					return true;
+
+				size_t front = std::min(_size, _capacity - head);
+
+				if(!func(&table[head], front))
+					return false;
+
+				if(front < _size)
+					return func(&table[0], _size - front);
+
+				return true;
+			}
+
+			void copy_to(T *target) const
+			{
+				segments([&](T *start, size_t count) -> bool {
+					if(std::is_trivially_copyable<T>::value)
+						std::memcpy((void *)target, (void *)start, sizeof(T) * count);
+					else
+						for(size_t i = 0; i < count; ++i)
+							new (&target[i]) T(start[i]);
+
+					target += count;
+
+					return true;
+				});
+			}
+
+			template<typename F> bool each(F func)
+			{
+				for(size_t i = 0; i < _size; ++i)
+				{
+					if(!func(table[slot(i)]))
+						return false;
+				}
+
+				return true;
+			}
+
+			class Iterator
+			{
+			private:
+				Deque *deque;
+				size_t index;
+
+			public:
+				Iterator(Deque *deque, size_t index) : deque(deque), index(index) {}
+
+				bool operator ==(const Iterator &other) const
+				{
+					return index == other.index;
+				}
+
+				bool operator !=(const Iterator &other) const
+				{
+					return index != other.index;
+				}
+
+				size_t position() const
+				{
+					return index;
+				}
+
+				T &operator ++()
+				{
+					return deque->table[deque->slot(++index)];
+				}
+
+				T &operator ++(int)
+				{
+					return deque->table[deque->slot(index++)];
+				}
+
+				T &operator*() const
+				{
+					return (*deque)[index];
+				}
+
+				T &operator ()() const
+				{
+					return (*deque)[index];
+				}
+			};
+
+			Iterator begin()
+			{
+				return Iterator(this, 0);
+			}
+
+			Iterator end()
+			{
+				return Iterator(this, _size);
+			}
+	};
+};
@@ -0,0 +1,264 @@
+#pragma once
+#include <stdint.h>
+#include "Internal/Common.hpp"
+#include "Internal/ControlGroup.hpp"
+#include "Allocator/Array.hpp"
+
+namespace Prelude
+{
+	/*
+	 * Open addressing counterpart to HashTable. Uses the same policy traits minus the next links.
+	 * A control byte per slot holds the low 7 bits of the hash, so a probe compares a whole group of slots at once
+	 * and only calls T::compare_key on tag matches.
+	 */
+	template<class K, class V, class T, class BaseAllocator = Allocator::Standard, template<class, class> class ArrayWrapper = Allocator::Array> class FlatHashTable
+	{
+		private:
+			typedef ArrayWrapper<V, BaseAllocator> Allocator;
+			typedef ArrayWrapper<uint8_t, BaseAllocator> ControlAllocator;
+			typedef typename Allocator::Storage Table;
+			typedef typename ControlAllocator::Storage ControlTable;
+
+			static const size_t not_found = (size_t)-1;
+
+			Table table;
+			ControlTable control;
+			Allocator allocator;
+			ControlAllocator control_allocator;
+			size_t mask;
+			size_t entries;
+			size_t tombstones;
+
+			static size_t limit(size_t size)
+			{
+				return size - size / 8;
+			}
+
+			static size_t find_slot(ControlTable control, size_t mask, size_t hash)
+			{
+				size_t groups = (mask + 1) / ControlGroup::width - 1;
+				size_t group = Control::hash_position(hash) & groups;
+
+				for(size_t step = 1;; ++step)
+				{
+					size_t base = group * ControlGroup::width;
+					ControlMask match = ControlGroup(&control[base]).match_empty_or_deleted();
+
+					if(match)
+						return base + match.first();
+
+					group = (group + step) & groups;
+				}
+			}
+
+			size_t find(K key, size_t hash)
+			{
+				size_t groups = (mask + 1) / ControlGroup::width - 1;
+				size_t group = Control::hash_position(hash) & groups;
+				uint8_t tag = Control::hash_tag(hash);
+
+				for(size_t step = 1;; ++step)
+				{
+					size_t base = group * ControlGroup::width;
+					ControlGroup current(&control[base]);
+					ControlMask match = current.match(tag);
+
+					while(match)
+					{
+						size_t index = base + match.next();
+
+						T::verify_value(table[index]);
+
+						if(T::compare_key(key, T::get_key(table[index])))
+							return index;
+					}
+
+					if(prelude_likely(current.match_empty()))
+						return not_found;
+
+					group = (group + step) & groups;
+				}
+			}
+
+			void allocate(size_t size)
+			{
+				mask = size - 1;
+				tombstones = 0;
+
+				table = allocator.allocate(size);
+				control = control_allocator.allocate(size);
+
+				std::memset(&control[0], Control::empty, size);
+			}
+
+			void rehash(size_t size)
+			{
+				Table old_table = table;
+				ControlTable old_control = control;
+				size_t old_size = mask + 1;
+
+				allocate(size);
+
+				for(size_t i = 0; i < old_size; ++i)
+				{
+					if(!Control::is_full(old_control[i]))
+						continue;
+
+					V entry = old_table[i];
+
+					T::verify_value(entry);
+
+					size_t hash = T::hash_key(T::get_key(entry));
+					size_t index = find_slot(control, mask, hash);
+
+					control[index] = Control::hash_tag(hash);
+					table[index] = entry;
+				}
+
+				allocator.free(old_table);
+				control_allocator.free(old_control);
+			}
+
+			void insert(size_t hash, V value)
+			{
+				size_t size = mask + 1;
+
+				if(prelude_unlikely(entries + tombstones + 1 > limit(size)))
+					rehash(entries + 1 > limit(size) / 2 ? size << 1 : size);
+
+				size_t index = find_slot(control, mask, hash);
+
+				if(control[index] == Control::deleted)
+					tombstones--;
+
+				control[index] = Control::hash_tag(hash);
+				table[index] = value;
+
+				entries++;
+			}
+
+		public:
+			FlatHashTable(size_t initial, typename Allocator::Reference allocator = Allocator::default_reference) : allocator(allocator), control_allocator(allocator)
+			{
+				entries = 0;
+
+				size_t size = (size_t)1 << initial;
+
+				if(size < ControlGroup::width)
+					size = ControlGroup::width;
+
+				allocate(size);
+			}
+
+			~FlatHashTable()
+			{
+				if(Allocator::can_free)
+				{
+					for(size_t i = 0; i <= mask; ++i)
+						if(Control::is_full(control[i]))
+							T::free_value(get_allocator(), table[i]);
+
+					allocator.free(table);
+					control_allocator.free(control);
+				}
+			}
+
+			template<typename F> void mark_content(F mark)
+			{
+				for(size_t i = 0; i <= mask; ++i)
+					if(Control::is_full(control[i]))
+						T::mark_value(table[i], mark);
+			}
+
+			template<typename F> void mark(F mark)
+			{
+				mark(table);
+				mark(control);
+			}
+
+			V get(K key)
+			{
+				if(prelude_unlikely(!T::valid_key(key)))
+					return T::invalid_value();
+
+				size_t hash = T::hash_key(key);
+				size_t index = find(key, hash);
+
+				if(index != not_found)
+					return table[index];
+
+				if(T::create_value())
+				{
+					V value = T::create_value(get_allocator(), key, hash);
+
+					insert(hash, value);
+
+					return value;
+				}
+				else
+					return T::invalid_value();
+			}
+
+			size_t get_entries()
+			{
+				return entries;
+			}
+
+			bool has(K key)
+			{
+				return find(key, T::hash_key(key)) != not_found;
+			}
+
+			bool set(K key, V value)
+			{
+				T::verify_value(value);
+
+				size_t hash = T::hash_key(key);
+				size_t index = find(key, hash);
+
+				if(index != not_found)
+				{
+					table[index] = value;
+					return true;
+				}
+
+				insert(hash, value);
+
+				return false;
+			}
+
+			V remove(K key)
+			{
+				size_t index = find(key, T::hash_key(key));
+
+				if(index == not_found)
+					return T::invalid_value();
+
+				V result = table[index];
+
+				control[index] = Control::deleted;
+				entries--;
+				tombstones++;
+
+				return result;
+			}
+
+			template<typename F> void each_value(F func)
+			{
+				for(size_t i = 0; i <= mask; ++i)
+				{
+					if(Control::is_full(control[i]))
+					{
+						T::verify_value(table[i]);
+
+						func(table[i]);
+					}
+				}
+			}
+
+			typename Allocator::Base::Reference get_allocator()
+			{
+				return allocator.reference();
+			}
+	};
+};
@@ -0,0 +1,264 @@
+#pragma once
+#include <stdint.h>
+#include "Internal/Common.hpp"
+#include "Internal/ControlGroup.hpp"
+#include "Allocator/Array.hpp"
+#include "Map.hpp"
+
+namespace Prelude
+{
+	/*
+	 * Map with the key/value pairs stored inline in the table, so insertions don't allocate a Pair each.
+	 * Pointers returned by get_ref are invalidated when the table grows.
+	 */
+	template<class K, class V, class T = MapFunctions<K, V>, class BaseAllocator = Allocator::Standard, template<class, class> class ArrayWrapper = Allocator::Array> class FlatMap
+	{
+		public:
+			struct Slot
+			{
+				K key;
+				V value;
+			};
+
+		private:
+			typedef ArrayWrapper<Slot, BaseAllocator> Allocator;
+			typedef ArrayWrapper<uint8_t, BaseAllocator> ControlAllocator;
+			typedef typename Allocator::Storage Table;
+			typedef typename ControlAllocator::Storage ControlTable;
+
+			Table table;
+			ControlTable control;
+			Allocator allocator;
+			ControlAllocator control_allocator;
+			size_t mask;
+			size_t entries;
+
+			static size_t find_slot(ControlTable control, size_t mask, size_t hash)
+			{
+				size_t groups = (mask + 1) / ControlGroup::width - 1;
+				size_t group = Control::hash_position(hash) & groups;
+
+				for(size_t step = 1;; ++step)
+				{
+					size_t base = group * ControlGroup::width;
+					ControlMask match = ControlGroup(&control[base]).match_empty();
+
+					if(match)
+						return base + match.first();
+
+					group = (group + step) & groups;
+				}
+			}
+
+			Slot *find(K key, size_t hash)
+			{
+				size_t groups = (mask + 1) / ControlGroup::width - 1;
+				size_t group = Control::hash_position(hash) & groups;
+				uint8_t tag = Control::hash_tag(hash);
+
+				for(size_t step = 1;; ++step)
+				{
+					size_t base = group * ControlGroup::width;
+					ControlGroup current(&control[base]);
+					ControlMask match = current.match(tag);
+
+					while(match)
+					{
+						Slot *slot = &table[base + match.next()];
+
+						if(T::compare_key(slot->key, key))
+							return slot;
+					}
+
+					if(prelude_likely(current.match_empty()))
+						return 0;
+
+					group = (group + step) & groups;
+				}
+			}
+
+			void allocate(size_t size)
+			{
+				mask = size - 1;
+
+				table = allocator.allocate(size);
+				control = control_allocator.allocate(size);
+
+				std::memset(&control[0], Control::empty, size);
+			}
+
+			void expand()
+			{
+				Table old_table = table;
+				ControlTable old_control = control;
+				size_t old_size = mask + 1;
+
+				allocate(old_size << 1);
+
+				for(size_t i = 0; i < old_size; ++i)
+				{
+					if(!Control::is_full(old_control[i]))
+						continue;
+
+					size_t index = find_slot(control, mask, T::hash_key(old_table[i].key));
+
+					control[index] = old_control[i];
+					table[index] = old_table[i];
+				}
+
+				allocator.free(old_table);
+				control_allocator.free(old_control);
+			}
+
+			Slot *insert(size_t hash, K key, V value)
+			{
+				size_t size = mask + 1;
+
+				if(prelude_unlikely(entries + 1 > size - size / 8))
+					expand();
+
+				size_t index = find_slot(control, mask, hash);
+
+				control[index] = Control::hash_tag(hash);
+				table[index].key = key;
+				table[index].value = value;
+
+				entries++;
+
+				return &table[index];
+			}
+
+			void initialize(size_t initial)
+			{
+				entries = 0;
+
+				size_t size = (size_t)1 << initial;
+
+				if(size < ControlGroup::width)
+					size = ControlGroup::width;
+
+				allocate(size);
+			}
+
+		public:
+			typedef K Key;
+			typedef V Value;
+
+			FlatMap(typename Allocator::Reference allocator = Allocator::default_reference) : allocator(allocator), control_allocator(allocator)
+			{
+				initialize(0);
+			}
+
+			FlatMap(size_t initial, typename Allocator::Reference allocator = Allocator::default_reference) : allocator(allocator), control_allocator(allocator)
+			{
+				initialize(initial);
+			}
+
+			~FlatMap()
+			{
+				if(Allocator::can_free)
+				{
+					allocator.free(table);
+					control_allocator.free(control);
+				}
+			}
+
+			V get(K key)
+			{
+				Slot *slot = find(key, T::hash_key(key));
+
+				if(slot)
+					return slot->value;
+
+				return T::invalid_value();
+			}
+
+			template<typename func> V try_get(K key, func fails)
+			{
+				Slot *slot = find(key, T::hash_key(key));
+
+				if(slot)
+					return slot->value;
+
+				return fails();
+			}
+
+			template<typename func> bool each_pair(func do_for_pair)
+			{
+				for(size_t i = 0; i <= mask; ++i)
+				{
+					if(Control::is_full(control[i]))
+					{
+						if(!do_for_pair(table[i].key, table[i].value))
+							return false;
+					}
+				}
+
+				return true;
+			}
+
+			template<typename F> void mark_content(F mark)
+			{
+				for(size_t i = 0; i <= mask; ++i)
+				{
+					if(Control::is_full(control[i]))
+						mark(table[i]);
+				}
+			}
+
+			template<typename F> void mark(F mark)
+			{
+				mark(table);
+				mark(control);
+			}
+
+			template<typename func> V get_create(K key, func create_value)
+			{
+				size_t hash = T::hash_key(key);
+				Slot *slot = find(key, hash);
+
+				if(slot)
+					return slot->value;
+
+				V value = create_value();
+
+				return insert(hash, key, value)->value;
+			}
+
+			V *get_ref(K key)
+			{
+				Slot *slot = find(key, T::hash_key(key));
+
+				if(slot)
+					return &slot->value;
+
+				return 0;
+			}
+
+			size_t get_entries()
+			{
+				return entries;
+			}
+
+			bool has(K key)
+			{
+				return find(key, T::hash_key(key)) != 0;
+			}
+
+			void set(K key, V value)
+			{
+				size_t hash = T::hash_key(key);
+				Slot *slot = find(key, hash);
+
+				if(slot)
+					slot->value = value;
+				else
+					insert(hash, key, value);
+			}
+
+			typename Allocator::Reference get_allocator()
+			{
+				return allocator.reference();
+			}
+	};
+};
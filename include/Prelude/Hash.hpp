@@ -0,0 +1,163 @@
+#pragma once
+#include <stdint.h>
+#include "Internal/Common.hpp"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+	#include <intrin.h>
+#endif
+
+namespace Prelude
+{
+	namespace Hash
+	{
+		static inline void multiply(uint64_t &a, uint64_t &b)
+		{
+			#if defined(__SIZEOF_INT128__)
+				__uint128_t result = (__uint128_t)a * b;
+				a = (uint64_t)result;
+				b = (uint64_t)(result >> 64);
+			#elif defined(_MSC_VER) && defined(_M_X64)
+				a = _umul128(a, b, &b);
+			#else
+				uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+				uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+				uint64_t t = rl + (rm0 << 32);
+				uint64_t c = t < rl;
+				uint64_t lo = t + (rm1 << 32);
+				c += lo < t;
+				a = lo;
+				b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+			#endif
+		}
+
+		static inline uint64_t mix(uint64_t a, uint64_t b)
+		{
+			multiply(a, b);
+			return a ^ b;
+		}
+
+		struct Identity
+		{
+			template<class K> static size_t hash(K key)
+			{
+				return (size_t)key;
+			}
+		};
+
+		/*
+		 * Multiplies by 2^64 / phi and folds the high half down, since tables index with the low bits.
+		 */
+		struct Fibonacci
+		{
+			template<class K> static size_t hash(K key)
+			{
+				uint64_t result = (uint64_t)key * 0x9E3779B97F4A7C15ull;
+
+				return (size_t)(result ^ (result >> 32));
+			}
+		};
+
+		/*
+		 * wyhash. Inputs over 48 bytes are consumed by three independent multiply lanes.
+		 */
+		struct Bytes
+		{
+			static const uint64_t seed = 0;
+
+			static uint64_t read64(const uint8_t *data)
+			{
+				uint64_t result;
+				std::memcpy(&result, data, sizeof(result));
+				return result;
+			}
+
+			static uint64_t read32(const uint8_t *data)
+			{
+				uint32_t result;
+				std::memcpy(&result, data, sizeof(result));
+				return result;
+			}
+
+			static size_t hash(const void *key, size_t length)
+			{
+				static const uint64_t s0 = 0xa0761d6478bd642full;
+				static const uint64_t s1 = 0xe7037ed1a0b428dbull;
+				static const uint64_t s2 = 0x8ebc6af09c88c6e3ull;
+				static const uint64_t s3 = 0x589965cc75374cc3ull;
+
+				const uint8_t *data = (const uint8_t *)key;
+				uint64_t state = seed ^ mix(seed ^ s0, s1);
+				uint64_t a, b;
+
+				if(prelude_likely(length <= 16))
+				{
+					if(length >= 4)
+					{
+						size_t middle = (length >> 3) << 2;
+
+						a = (read32(data) << 32) | read32(data + middle);
+						b = (read32(data + length - 4) << 32) | read32(data + length - 4 - middle);
+					}
+					else if(length > 0)
+					{
+						a = ((uint64_t)data[0] << 16) | ((uint64_t)data[length >> 1] << 8) | data[length - 1];
+						b = 0;
+					}
+					else
+						a = b = 0;
+				}
+				else
+				{
+					size_t left = length;
+
+					if(prelude_unlikely(left > 48))
+					{
+						uint64_t lane1 = state;
+						uint64_t lane2 = state;
+
+						do
+						{
+							state = mix(read64(data) ^ s1, read64(data + 8) ^ state);
+							lane1 = mix(read64(data + 16) ^ s2, read64(data + 24) ^ lane1);
+							lane2 = mix(read64(data + 32) ^ s3, read64(data + 40) ^ lane2);
+
+							data += 48;
+							left -= 48;
+						}
+						while(left > 48);
+
+						state ^= lane1 ^ lane2;
+					}
+
+					while(left > 16)
+					{
+						state = mix(read64(data) ^ s1, read64(data + 8) ^ state);
+
+						data += 16;
+						left -= 16;
+					}
+
+					a = read64(data + left - 16);
+					b = read64(data + left - 8);
+				}
+
+				a ^= s1;
+				b ^= state;
+
+				multiply(a, b);
+
+				return (size_t)mix(a ^ s0 ^ length, b ^ s1);
+			}
+
+			static size_t hash(const char *key)
+			{
+				return hash(key, std::strlen(key));
+			}
+
+			static size_t hash(const std::string &key)
+			{
+				return hash(key.data(), key.size());
+			}
+		};
+	};
+};
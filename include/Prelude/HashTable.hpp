@@ -1,15 +1,16 @@
 #pragma once
 #include "Internal/Common.hpp"
 #include "Allocator/Array.hpp"
+#include "Hash.hpp"
 
 namespace Prelude
 {
-	template<class K, class V, typename Allocator = Allocator::Standard> class HashTableFunctions
+	template<class K, class V, typename Allocator = Allocator::Standard, class Hasher = Hash::Fibonacci> class HashTableFunctions
 	{
 		public:
 			static size_t hash_key(K key)
 			{
-				return (size_t)key;
+				return Hasher::hash(key);
 			}
 
 			static V invalid_value()
@@ -17,6 +18,11 @@ namespace Prelude
 				return 0;
 			}
 
+			static bool compare_key(K key, K other)
+			{
+				return key == other;
+			}
+
 			static bool valid_key(K key)
 			{
 				return key != 0;
@@ -49,26 +55,40 @@ namespace Prelude
 			{
 			}
 	};
+	
+	template<class V, typename Allocator = Allocator::Standard, class Hasher = Hash::Bytes> class StringHashTableFunctions:
+		public HashTableFunctions<const char *, V, Allocator, Hasher>
+	{
+		public:
+			static bool compare_key(const char *key, const char *other)
+			{
+				return std::strcmp(key, other) == 0;
+			}
+	};
 
-	template<class K, class V, class T, class BaseAllocator = Allocator::Standard, template<class, class> class ArrayWrapper = Allocator::Array> class HashTable
+	template<class K, class V, class T, class BaseAllocator = Allocator::Standard, template<class, class> class ArrayWrapper = Allocator::Array, bool incremental = false> class HashTable
 	{
 		private:
 			typedef ArrayWrapper<V, BaseAllocator> Allocator;
 			typedef typename Allocator::Storage Table;
 			
+			static const size_t migrate_buckets = 4;
+			
 			Table table;
 			Allocator allocator;
 			size_t mask;
 			size_t entries;
+			
+			Table old_table;
+			size_t old_mask;
+			size_t migrated;
 
-			static bool store(Table table, size_t mask, K key, V value)
+			static bool store(V *slot, K key, V value)
 			{
 				T::verify_value(value);
 
-				size_t hash = T::hash_key(key);
-				size_t index = hash & mask;
-				V entry = table[index];
-				V tail = entry;
+				V entry = *slot;
+				V tail = T::invalid_value();
 				
 				T::verify_value(entry);
 
@@ -76,7 +96,7 @@ namespace Prelude
 				{
 					T::verify_value(entry);
 
-					if(T::compare_key_value(key, hash, entry))
+					if(T::compare_key(key, T::get_key(entry)))
 					{
 						if(T::valid_value(tail))
 						{
@@ -87,8 +107,8 @@ namespace Prelude
 						}
 						else
 						{
-							table[index] = value;
-							T::set_value_next(value, T::invalid_value());
+							*slot = value;
+							T::set_value_next(value, T::get_value_next(entry));
 						}
 						
 						return true;
@@ -103,46 +123,134 @@ namespace Prelude
 				if(T::valid_value(tail))
 					T::set_value_next(tail, value);
 				else
-					table[index] = value;
+					*slot = value;
 
 				T::set_value_next(value, T::invalid_value());
 
 				return false;
 			}
-
-			void expand()
+			
+			V *bucket(size_t hash)
 			{
-				size_t size = (this->mask + 1) << 1;
-				size_t mask = size - 1;
+				if(incremental && old_table)
+				{
+					size_t index = hash & old_mask;
+					
+					if(index >= migrated)
+						return &old_table[index];
+				}
+				
+				return &table[hash & mask];
+			}
+			
+			void relink(size_t index)
+			{
+				V entry = old_table[index];
+				
+				old_table[index] = T::invalid_value();
 
-				Table table = allocator.allocate(size);
+				while(T::valid_value(entry))
+				{
+					T::verify_value(entry);
+
+					V next = T::get_value_next(entry);
+					V *slot = &table[T::hash_key(T::get_key(entry)) & mask];
+					
+					T::set_value_next(entry, *slot);
+					*slot = entry;
+					
+					entry = next;
+				}
+			}
+			
+			void migrate(size_t buckets)
+			{
+				size_t end = migrated + buckets;
 				
-				if(!Allocator::null_references)
-					for(size_t i = 0; i < size; ++i)
-						table[i] = T::invalid_value();
+				if(end > old_mask + 1)
+					end = old_mask + 1;
 				
-				V *end = this->table + (this->mask + 1);
+				for(; migrated < end; ++migrated)
+					relink(migrated);
 				
-				for(V *slot = this->table; slot != end; ++slot)
+				if(migrated > old_mask)
+				{
+					allocator.free(old_table);
+					old_table = nullptr;
+				}
+			}
+			
+			void step()
+			{
+				if(incremental && old_table)
+					migrate(migrate_buckets);
+			}
+
+			void split()
+			{
+				size_t old_size = mask + 1;
+				size_t size = old_size << 1;
+
+				table = allocator.reallocate(table, old_size, size);
+				mask = size - 1;
+
+				for(size_t i = old_size; i < size; ++i)
+					table[i] = T::invalid_value();
+
+				for(size_t i = 0; i < old_size; ++i)
 				{
-					V entry = *slot;
+					V entry = table[i];
+					V tails[2] = {T::invalid_value(), T::invalid_value()};
+
+					table[i] = T::invalid_value();
 
 					while(T::valid_value(entry))
 					{
 						T::verify_value(entry);
 
 						V next = T::get_value_next(entry);
-						
-						store(table, mask, T::get_key(entry), entry);
-						
+						size_t half = (T::hash_key(T::get_key(entry)) & old_size) ? 1 : 0;
+
+						if(T::valid_value(tails[half]))
+							T::set_value_next(tails[half], entry);
+						else
+							table[i + half * old_size] = entry;
+
+						tails[half] = entry;
 						entry = next;
 					}
+
+					for(size_t half = 0; half < 2; ++half)
+						if(T::valid_value(tails[half]))
+							T::set_value_next(tails[half], T::invalid_value());
 				}
+			}
 
-				allocator.free(this->table);
+			void expand()
+			{
+				if(!incremental)
+				{
+					split();
+					return;
+				}
+				
+				if(old_table)
+					migrate(old_mask + 1);
+				
+				old_table = this->table;
+				old_mask = this->mask;
+				migrated = 0;
+				
+				size_t size = (this->mask + 1) << 1;
 
-				this->mask = mask;
-				this->table = table;
+				this->table = allocator.allocate(size);
+				this->mask = size - 1;
+				
+				if(!Allocator::null_references)
+					for(size_t i = 0; i < size; ++i)
+						this->table[i] = T::invalid_value();
+				
+				migrate(migrate_buckets);
 			}
 
 			void increase()
@@ -152,6 +260,33 @@ namespace Prelude
 				if(prelude_unlikely(entries > mask))
 					expand();
 			}
+			
+			template<typename F> static void each_table_value(Table table, size_t start, size_t mask, F func)
+			{
+				for(size_t i = start; i <= mask; ++i)
+				{
+					V entry = table[i];
+
+					while(T::valid_value(entry))
+					{
+						T::verify_value(entry);
+						
+						V next = T::get_value_next(entry);
+
+						func(entry);
+						
+						entry = next;
+					}
+				}
+			}
+			
+			template<typename F> void each_entry(F func)
+			{
+				if(incremental && old_table)
+					each_table_value(old_table, migrated, old_mask, func);
+				
+				each_table_value(table, 0, mask, func);
+			}
 
 		protected:
 			V* get_table()
@@ -168,6 +303,7 @@ namespace Prelude
 			HashTable(size_t initial, typename Allocator::Reference allocator = Allocator::default_reference) : allocator(allocator)
 			{
 				entries = 0;
+				old_table = nullptr;
 				
 				size_t size = 1 << initial;
 				mask = size - 1;
@@ -182,21 +318,12 @@ namespace Prelude
 			{
 				if(Allocator::can_free)
 				{
-					V *end = &table[0] + (this->mask + 1);
-
-					for(V *slot = &table[0]; slot != end; ++slot)
-					{
-						V entry = *slot;
-
-						while(T::valid_value(entry))
-						{
-							V next = T::get_value_next(entry);
-
-							T::free_value(get_allocator(), entry);
-
-							entry = next;
-						}
-					}
+					each_entry([&](V entry) {
+						T::free_value(get_allocator(), entry);
+					});
+					
+					if(incremental && old_table)
+						allocator.free(old_table);
 					
 					allocator.free(this->table);
 				}
@@ -207,29 +334,38 @@ namespace Prelude
 				for(size_t i = 0; i <= mask; ++i)
 					if(T::valid_value(table[i]))
 						T::mark_value(table[i], mark);
-			
+				
+				if(incremental && old_table)
+					for(size_t i = migrated; i <= old_mask; ++i)
+						if(T::valid_value(old_table[i]))
+							T::mark_value(old_table[i], mark);
 			}
 
 			template<typename F> void mark(F mark)
 			{
 				mark(table);
+				
+				if(incremental && old_table)
+					mark(old_table);
 			}
 
 			V get(K key)
 			{
 				if(prelude_unlikely(!T::valid_key(key)))
 					return 0;
+				
+				step();
 
 				size_t hash = T::hash_key(key);
-				size_t index = hash & mask;
-				V entry = table[index];
+				V *slot = bucket(hash);
+				V entry = *slot;
 				V tail = entry;
 
 				while(T::valid_value(entry))
 				{
 					T::verify_value(entry);
 
-					if(T::compare_key_value(key, hash, entry))
+					if(T::compare_key(key, T::get_key(entry)))
 						return entry;
 
 					tail = entry;
@@ -243,7 +379,7 @@ namespace Prelude
 					if(tail)
 						T::set_value_next(tail, value);
 					else
-						table[index] = value;
+						*slot = value;
 
 					T::set_value_next(value, T::invalid_value());
 
@@ -262,15 +398,16 @@ namespace Prelude
 			
 			bool has(K key)
 			{
+				step();
+				
 				size_t hash = T::hash_key(key);
-				size_t index = hash & mask;
-				V entry = table[index];
+				V entry = *bucket(hash);
 
 				while(T::valid_value(entry))
 				{
 					T::verify_value(entry);
 
-					if(T::compare_key_value(key, hash, entry))
+					if(T::compare_key(key, T::get_key(entry)))
 						return true;
 					
 					entry = T::get_value_next(entry);
@@ -281,7 +418,10 @@ namespace Prelude
 
 			bool set(K key, V value)
 			{
-				bool exists = store(table, mask, key, value);
+				step();
+				
+				size_t hash = T::hash_key(key);
+				bool exists = store(bucket(hash), key, value);
 
 				if(!exists)
 					increase();
@@ -291,19 +431,7 @@ namespace Prelude
 			
 			template<typename F> void each_value(F func)
 			{
-				for(size_t i = 0; i <= mask; ++i)
-				{
-					V entry = table[i];
-
-					while(T::valid_value(entry))
-					{
-						T::verify_value(entry);
-
-						func(entry);
-						
-						entry = T::get_value_next(entry);
-					}
-				}
+				each_entry(func);
 			}
 			
 			typename Allocator::Base::Reference get_allocator()
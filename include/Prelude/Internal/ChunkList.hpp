@@ -1,10 +1,35 @@
 #pragma once
+#include <stdint.h>
 #include "Common.hpp"
 #include "../FastList.hpp"
+#include "../Allocator.hpp"
 
 namespace Prelude
 {
-	template<typename Allocator> class ChunkList
+	namespace ChunkGrowth
+	{
+		template<size_t size> struct Fixed
+		{
+			static const size_t initial = size;
+			
+			static size_t next(size_t current)
+			{
+				return current;
+			}
+		};
+		
+		template<size_t start, size_t limit> struct Doubling
+		{
+			static const size_t initial = start;
+			
+			static size_t next(size_t current)
+			{
+				return current < limit ? current << 1 : limit;
+			}
+		};
+	};
+	
+	template<typename Allocator = Allocator::Standard, class Growth = ChunkGrowth::Fixed<0x1000> > class ChunkList
 	{
 		struct Chunk
 		{
@@ -13,10 +38,24 @@ namespace Prelude
 		
 		private:
 			FastList<Chunk> chunks;
-			typename Allocator::Ref::Storage allocator;
+			Allocator allocator;
+			size_t chunk_size;
 
 		public:
-			ChunkList(typename Allocator::Ref::Type allocator = Allocator::Ref::standard) : allocator(allocator) {}
+			ChunkList(typename Allocator::Reference allocator = Allocator::default_reference) : allocator(allocator), chunk_size(Growth::initial) {}
+			
+			size_t page_size()
+			{
+				return chunk_size - sizeof(Chunk);
+			}
+			
+			void *allocate_page(size_t &bytes)
+			{
+				bytes = page_size();
+				chunk_size = Growth::next(chunk_size);
+				
+				return allocate(bytes);
+			}
 			
 			void *allocate(size_t bytes)
 			{
@@ -33,12 +72,15 @@ namespace Prelude
 			
 			~ChunkList()
 			{
+				if(!Allocator::can_free)
+					return;
+				
 				typename FastList<Chunk>::Iterator chunk = chunks.begin();
 
 				while(chunk != chunks.end())
 				{
 					Chunk *current = *chunk;
-					++chunk;
+					chunk.step();
 					allocator.free(current);
 				};
 			}
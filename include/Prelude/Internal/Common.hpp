@@ -30,6 +30,7 @@
 #endif
 
 #ifdef _MSC_VER
+	#include <intrin.h>
 	#ifndef WIN32
 		#define WIN32 1
 	#endif
@@ -98,4 +99,17 @@ namespace Prelude
 	{
 		return value & ~(alignment - 1);
 	};
+
+	static inline size_t count_trailing_zeros(uint32_t value)
+	{
+		prelude_debug_assert(value != 0);
+
+		#ifdef _MSC_VER
+			unsigned long result;
+			_BitScanForward(&result, value);
+			return result;
+		#else
+			return __builtin_ctz(value);
+		#endif
+	}
 };
@@ -0,0 +1,146 @@
+#pragma once
+#include <stdint.h>
+#include "Common.hpp"
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define prelude_control_group_sse2 1
+#endif
+
+namespace Prelude
+{
+	namespace Control
+	{
+		static const uint8_t empty = 0x80;
+		static const uint8_t deleted = 0xFE;
+
+		static inline bool is_full(uint8_t control)
+		{
+			return (control & 0x80) == 0;
+		}
+
+		static inline size_t hash_position(size_t hash)
+		{
+			return hash >> 7;
+		}
+
+		static inline uint8_t hash_tag(size_t hash)
+		{
+			return (uint8_t)(hash & 0x7F);
+		}
+	};
+
+	class ControlMask
+	{
+		private:
+			uint32_t mask;
+
+		public:
+			ControlMask(uint32_t mask) : mask(mask) {}
+
+			operator bool() const
+			{
+				return mask != 0;
+			}
+
+			size_t first() const
+			{
+				return count_trailing_zeros(mask);
+			}
+
+			size_t next()
+			{
+				size_t result = first();
+
+				mask &= mask - 1;
+
+				return result;
+			}
+	};
+
+	class ControlGroup
+	{
+		private:
+			#if defined(__AVX2__)
+				__m256i control;
+			#elif defined(prelude_control_group_sse2)
+				__m128i control;
+			#else
+				const uint8_t *control;
+			#endif
+
+		public:
+			#if defined(__AVX2__)
+				static const size_t width = 32;
+
+				ControlGroup(const uint8_t *position) : control(_mm256_loadu_si256((const __m256i *)position)) {}
+
+				ControlMask match(uint8_t tag) const
+				{
+					return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_set1_epi8((char)tag), control));
+				}
+
+				ControlMask match_empty() const
+				{
+					return match(Control::empty);
+				}
+
+				ControlMask match_empty_or_deleted() const
+				{
+					return (uint32_t)_mm256_movemask_epi8(control);
+				}
+			#elif defined(prelude_control_group_sse2)
+				static const size_t width = 16;
+
+				ControlGroup(const uint8_t *position) : control(_mm_loadu_si128((const __m128i *)position)) {}
+
+				ControlMask match(uint8_t tag) const
+				{
+					return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8((char)tag), control));
+				}
+
+				ControlMask match_empty() const
+				{
+					return match(Control::empty);
+				}
+
+				ControlMask match_empty_or_deleted() const
+				{
+					return (uint32_t)_mm_movemask_epi8(control);
+				}
+			#else
+				static const size_t width = 8;
+
+				ControlGroup(const uint8_t *position) : control(position) {}
+
+				ControlMask match(uint8_t tag) const
+				{
+					uint32_t result = 0;
+
+					for(size_t i = 0; i < width; ++i)
+						if(control[i] == tag)
+							result |= 1 << i;
+
+					return result;
+				}
+
+				ControlMask match_empty() const
+				{
+					return match(Control::empty);
+				}
+
+				ControlMask match_empty_or_deleted() const
+				{
+					uint32_t result = 0;
+
+					for(size_t i = 0; i < width; ++i)
+						if(!Control::is_full(control[i]))
+							result |= 1 << i;
+
+					return result;
+				}
+			#endif
+	};
+};
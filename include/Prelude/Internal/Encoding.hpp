@@ -0,0 +1,62 @@
+#pragma once
+#include <stdint.h>
+#include <type_traits>
+#include "Common.hpp"
+
+namespace Prelude
+{
+	namespace Encoding
+	{
+		static const size_t max_varint = 10;
+
+		template<typename T> static inline uint8_t *write_le(uint8_t *position, T value)
+		{
+			static_assert(std::is_integral<T>::value, "write_le only encodes integers");
+
+			typedef typename std::make_unsigned<T>::type U;
+
+			U bits = (U)value;
+
+			for(size_t i = 0; i < sizeof(T); ++i)
+				position[i] = (uint8_t)(bits >> (i * 8));
+
+			return position + sizeof(T);
+		}
+
+		static inline size_t varint_size(uint64_t value)
+		{
+			size_t result = 1;
+
+			while(value >= 0x80)
+			{
+				value >>= 7;
+				result++;
+			}
+
+			return result;
+		}
+
+		static inline uint8_t *write_varint(uint8_t *position, uint64_t value)
+		{
+			while(value >= 0x80)
+			{
+				*position++ = (uint8_t)(value | 0x80);
+				value >>= 7;
+			}
+
+			*position++ = (uint8_t)value;
+
+			return position;
+		}
+
+		static inline uint64_t zigzag(int64_t value)
+		{
+			return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+		}
+
+		static inline uint8_t *write_signed_varint(uint8_t *position, int64_t value)
+		{
+			return write_varint(position, zigzag(value));
+		}
+	};
+};
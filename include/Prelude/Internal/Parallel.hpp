@@ -0,0 +1,39 @@
+#pragma once
+#include <atomic>
+#include "Common.hpp"
+#include "../ThreadPool.hpp"
+
+namespace Prelude
+{
+	namespace Parallel
+	{
+		static const size_t default_grain = 0x4000;
+
+		static inline size_t blocks(size_t count, size_t grain)
+		{
+			return (count + grain - 1) / grain;
+		}
+
+		/*
+		 * Splits [0, count) into blocks of grain entries and calls func(block, start, end) for each of them on
+		 * the pool's workers. Once func returns false no new blocks are started and the result is false.
+		 */
+		template<typename F> bool for_blocks(size_t count, size_t grain, F func, ThreadPool &pool = ThreadPool::standard())
+		{
+			std::atomic<bool> stop(false);
+
+			pool.parallel_for(0, blocks(count, grain), 1, [&](size_t first, size_t last) {
+				for(size_t i = first; i < last && !stop.load(std::memory_order_relaxed); ++i)
+				{
+					size_t start = i * grain;
+					size_t end = start + grain < count ? start + grain : count;
+
+					if(!func(i, start, end))
+						stop.store(true, std::memory_order_relaxed);
+				}
+			});
+
+			return !stop.load(std::memory_order_relaxed);
+		}
+	};
+};
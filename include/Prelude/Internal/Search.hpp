@@ -0,0 +1,160 @@
+#pragma once
+#include <stdint.h>
+#include <type_traits>
+#include "Common.hpp"
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define prelude_search_sse2 1
+#endif
+
+namespace Prelude
+{
+	namespace Search
+	{
+		/*
+		 * Types whose equality is a bitwise comparison of 1, 2, 4 or 8 bytes, so they can be compared a vector register at a time.
+		 */
+		template<class T> struct Vectorizable
+		{
+			static const bool value = (std::is_integral<T>::value || std::is_pointer<T>::value || std::is_enum<T>::value) && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+		};
+
+		template<size_t size> struct Lanes;
+
+		#if defined(__AVX2__)
+			static const size_t width = 32;
+
+			typedef __m256i Register;
+
+			static inline Register load(const void *position)
+			{
+				return _mm256_loadu_si256((const __m256i *)position);
+			}
+
+			static inline uint32_t movemask(Register value)
+			{
+				return (uint32_t)_mm256_movemask_epi8(value);
+			}
+
+			template<> struct Lanes<1>
+			{
+				static Register splat(const void *value) { return _mm256_set1_epi8(*(const char *)value); }
+				static Register equal(Register a, Register b) { return _mm256_cmpeq_epi8(a, b); }
+			};
+
+			template<> struct Lanes<2>
+			{
+				static Register splat(const void *value) { return _mm256_set1_epi16(*(const short *)value); }
+				static Register equal(Register a, Register b) { return _mm256_cmpeq_epi16(a, b); }
+			};
+
+			template<> struct Lanes<4>
+			{
+				static Register splat(const void *value) { return _mm256_set1_epi32(*(const int *)value); }
+				static Register equal(Register a, Register b) { return _mm256_cmpeq_epi32(a, b); }
+			};
+
+			template<> struct Lanes<8>
+			{
+				static Register splat(const void *value) { return _mm256_set1_epi64x(*(const long long *)value); }
+				static Register equal(Register a, Register b) { return _mm256_cmpeq_epi64(a, b); }
+			};
+		#elif defined(prelude_search_sse2)
+			static const size_t width = 16;
+
+			typedef __m128i Register;
+
+			static inline Register load(const void *position)
+			{
+				return _mm_loadu_si128((const __m128i *)position);
+			}
+
+			static inline uint32_t movemask(Register value)
+			{
+				return (uint32_t)_mm_movemask_epi8(value);
+			}
+
+			template<> struct Lanes<1>
+			{
+				static Register splat(const void *value) { return _mm_set1_epi8(*(const char *)value); }
+				static Register equal(Register a, Register b) { return _mm_cmpeq_epi8(a, b); }
+			};
+
+			template<> struct Lanes<2>
+			{
+				static Register splat(const void *value) { return _mm_set1_epi16(*(const short *)value); }
+				static Register equal(Register a, Register b) { return _mm_cmpeq_epi16(a, b); }
+			};
+
+			template<> struct Lanes<4>
+			{
+				static Register splat(const void *value) { return _mm_set1_epi32(*(const int *)value); }
+				static Register equal(Register a, Register b) { return _mm_cmpeq_epi32(a, b); }
+			};
+
+			template<> struct Lanes<8>
+			{
+				static Register splat(const void *value)
+				{
+					int64_t result;
+
+					std::memcpy(&result, value, sizeof(result));
+
+					return _mm_set_epi32((int)(result >> 32), (int)result, (int)(result >> 32), (int)result);
+				}
+
+				static Register equal(Register a, Register b)
+				{
+					Register halves = _mm_cmpeq_epi32(a, b);
+
+					return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+				}
+			};
+		#endif
+
+		template<class T> const T *find_scalar(const T *start, const T *end, const T &value)
+		{
+			for(; start != end; ++start)
+			{
+				if(*start == value)
+					return start;
+			}
+
+			return nullptr;
+		}
+
+		#if defined(__AVX2__) || defined(prelude_search_sse2)
+			template<class T> typename std::enable_if<Vectorizable<T>::value, const T *>::type find(const T *start, size_t count, const T &value)
+			{
+				typedef Lanes<sizeof(T)> Lane;
+
+				const T *end = start + count;
+				const size_t step = width / sizeof(T);
+				Register needle = Lane::splat(&value);
+
+				for(; (size_t)(end - start) >= step; start += step)
+				{
+					uint32_t mask = movemask(Lane::equal(load(start), needle));
+
+					if(mask)
+						return start + count_trailing_zeros(mask) / sizeof(T);
+				}
+
+				return find_scalar(start, end, value);
+			}
+		#else
+			template<class T> typename std::enable_if<Vectorizable<T>::value, const T *>::type find(const T *start, size_t count, const T &value)
+			{
+				return find_scalar(start, start + count, value);
+			}
+		#endif
+
+		template<class T> typename std::enable_if<!Vectorizable<T>::value, const T *>::type find(const T *start, size_t count, const T &value)
+		{
+			return find_scalar(start, start + count, value);
+		}
+	};
+};
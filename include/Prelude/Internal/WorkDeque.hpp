@@ -0,0 +1,150 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include "Common.hpp"
+#include "../Allocator.hpp"
+
+namespace Prelude
+{
+	/*
+	 * Chase-Lev deque. The owning thread pushes and pops at the bottom while other threads steal from the top.
+	 * Arrays replaced by growth are kept until the deque is destroyed since a thief may still be reading them.
+	 */
+	template<class T, class BaseAllocator = Allocator::Standard> class WorkDeque
+	{
+		private:
+			struct Array
+			{
+				size_t mask;
+				Array *retired;
+
+				std::atomic<T> &operator [](ptrdiff_t index)
+				{
+					return ((std::atomic<T> *)(this + 1))[(size_t)index & mask];
+				}
+			};
+
+			BaseAllocator allocator;
+			std::atomic<ptrdiff_t> top;
+			std::atomic<ptrdiff_t> bottom;
+			std::atomic<Array *> array;
+
+			Array *allocate_array(size_t size)
+			{
+				Array *result = new (allocator.allocate(sizeof(Array) + size * sizeof(std::atomic<T>))) Array;
+
+				result->mask = size - 1;
+				result->retired = nullptr;
+
+				for(size_t i = 0; i < size; ++i)
+					new (&(*result)[i]) std::atomic<T>(T());
+
+				return result;
+			}
+
+			Array *grow(Array *old, ptrdiff_t start, ptrdiff_t end)
+			{
+				Array *result = allocate_array((old->mask + 1) << 1);
+
+				for(ptrdiff_t i = start; i < end; ++i)
+					(*result)[i].store((*old)[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+				result->retired = old;
+
+				array.store(result, std::memory_order_release);
+
+				return result;
+			}
+
+		public:
+			WorkDeque(size_t initial = 8, typename BaseAllocator::Reference allocator = BaseAllocator::default_reference) : allocator(allocator), top(0), bottom(0)
+			{
+				array.store(allocate_array((size_t)1 << initial), std::memory_order_relaxed);
+			}
+
+			~WorkDeque()
+			{
+				Array *current = array.load(std::memory_order_relaxed);
+
+				while(current)
+				{
+					Array *next = current->retired;
+
+					allocator.free((void *)current);
+
+					current = next;
+				}
+			}
+
+			void push(T value)
+			{
+				ptrdiff_t end = bottom.load(std::memory_order_relaxed);
+				ptrdiff_t start = top.load(std::memory_order_acquire);
+				Array *current = array.load(std::memory_order_relaxed);
+
+				if(prelude_unlikely((size_t)(end - start) > current->mask))
+					current = grow(current, start, end);
+
+				(*current)[end].store(value, std::memory_order_relaxed);
+
+				std::atomic_thread_fence(std::memory_order_release);
+
+				bottom.store(end + 1, std::memory_order_relaxed);
+			}
+
+			T pop()
+			{
+				ptrdiff_t end = bottom.load(std::memory_order_relaxed) - 1;
+				Array *current = array.load(std::memory_order_relaxed);
+
+				bottom.store(end, std::memory_order_relaxed);
+
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				ptrdiff_t start = top.load(std::memory_order_relaxed);
+
+				if(start > end)
+				{
+					bottom.store(end + 1, std::memory_order_relaxed);
+
+					return T();
+				}
+
+				T result = (*current)[end].load(std::memory_order_relaxed);
+
+				if(start == end)
+				{
+					if(!top.compare_exchange_strong(start, start + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+						result = T();
+
+					bottom.store(end + 1, std::memory_order_relaxed);
+				}
+
+				return result;
+			}
+
+			T steal()
+			{
+				ptrdiff_t start = top.load(std::memory_order_acquire);
+
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				ptrdiff_t end = bottom.load(std::memory_order_acquire);
+
+				if(start >= end)
+					return T();
+
+				T result = (*array.load(std::memory_order_acquire))[start].load(std::memory_order_relaxed);
+
+				if(!top.compare_exchange_strong(start, start + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					return T();
+
+				return result;
+			}
+
+			bool empty() const
+			{
+				return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+			}
+	};
+};
@@ -2,68 +2,216 @@
 #include <stdint.h>
 #include "List.hpp"
 #include "Allocator.hpp"
+#include "Internal/ChunkList.hpp"
+#include "Internal/Encoding.hpp"
+
+#ifndef WIN32
+	#include <errno.h>
+	#include <sys/uio.h>
+#endif
 
 namespace Prelude
 {
-	template<size_t buffer_size, typename Allocator = Allocator::Standard> class JoiningBuffer
+	namespace BufferStorage
+	{
+		/*
+		 * Keeps the data of each buffer right after its header. Buffers can be reused, so reset() keeps them on a spare list.
+		 */
+		struct Heap
+		{
+			struct Segment
+			{
+			};
+
+			static const bool reusable = true;
+
+			void attach()
+			{
+			}
+
+			void detach()
+			{
+			}
+
+			template<class Buffer> static uint8_t *data(Buffer *buffer)
+			{
+				return (uint8_t *)(buffer + 1);
+			}
+
+			template<class Buffer, class Allocator> Buffer *allocate(Allocator &allocator, size_t, size_t capacity)
+			{
+				return new (allocator.allocate(capacity + sizeof(Buffer))) Buffer;
+			}
+
+			template<class Buffer> void release(Buffer *)
+			{
+			}
+		};
+	};
+
+	/*
+	 * Growth picks the size of each new buffer, starting at buffer_size. Larger allocations get a buffer of their own.
+	 * reset() keeps the buffers on a spare list so a reused JoiningBuffer stops allocating once it has seen its largest output.
+	 * Storage decides where the data of a buffer lives, see MappedJoiningBuffer.hpp for buffers in a file.
+	 */
+	template<size_t buffer_size, typename Allocator = Allocator::Standard, class Growth = ChunkGrowth::Fixed<buffer_size>, class Storage = BufferStorage::Heap> class JoiningBuffer
 	{
 		private:
-			struct Buffer
+			struct Buffer:
+				public Storage::Segment
 			{
 				ListEntry<Buffer> entry;
 				size_t size;
+				size_t capacity;
 			};
 			
 			List<Buffer> buffer_list;
+			List<Buffer> spare_list;
+			size_t buffer_capacity;
 
 			uint8_t *current;
 			uint8_t *max;
 			size_t bytes;
 			
 			Allocator allocator;
+			Storage storage;
 
 			void update()
 			{
 				Buffer *buffer = buffer_list.last;
 
 				if(buffer)
-					buffer->size = (size_t)current - (size_t)(buffer + 1);
+					buffer->size = (size_t)current - (size_t)Storage::data(buffer);
 			}
 
-			void *get_buffer(size_t bytes)
+			Buffer *take_spare(size_t bytes)
+			{
+				Buffer *prev = nullptr;
+				
+				for(Buffer *buffer = spare_list.first; buffer; prev = buffer, buffer = buffer->entry.next)
+				{
+					if(buffer->capacity < bytes)
+						continue;
+					
+					if(prev)
+						prev->entry.next = buffer->entry.next;
+					else
+						spare_list.first = buffer->entry.next;
+					
+					if(spare_list.last == buffer)
+						spare_list.last = prev;
+					
+					return buffer;
+				}
+				
+				return nullptr;
+			}
+			
+			Buffer *allocate_buffer(size_t bytes)
 			{
-				prelude_debug_assert(bytes <= buffer_size);
+				size_t capacity = buffer_capacity;
+				
+				if(bytes > capacity)
+					capacity = bytes;
+				else
+					buffer_capacity = Growth::next(buffer_capacity);
+				
+				Buffer *result = storage.template allocate<Buffer>(allocator, this->bytes, capacity);
 				
+				result->capacity = capacity;
+				
+				return result;
+			}
+			
+			void next_buffer(size_t bytes)
+			{
 				update();
 				
-				Buffer *result = new (allocator.allocate(buffer_size + sizeof(Buffer))) Buffer;
+				Buffer *result = take_spare(bytes);
+				
+				if(!result)
+					result = allocate_buffer(bytes);
+				
+				result->size = 0;
 				
 				buffer_list.append(result);
 				
-				current = (uint8_t *)(result + 1);
-				max = current + buffer_size;
+				current = Storage::data(result);
+				max = current + result->capacity;
+			}
+			
+			void *get_buffer(size_t bytes)
+			{
+				next_buffer(bytes);
 				
 				return allocate(bytes);
 			}
+			
+			void free_buffer(Buffer *buffer)
+			{
+				storage.release(buffer);
+				
+				if(Allocator::can_free)
+					allocator.free(buffer);
+			}
+			
+			void free_list(List<Buffer> &list)
+			{
+				Buffer *buffer = list.first;
+				
+				while(buffer)
+				{
+					Buffer *next = buffer->entry.next;
+					free_buffer(buffer);
+					buffer = next;
+				}
+				
+				list.clear();
+			}
 						
 		public:
-			JoiningBuffer(typename Allocator::Reference allocator = Allocator::default_reference) : current(0), max(0), bytes(0), allocator(allocator)
+			JoiningBuffer(typename Allocator::Reference allocator = Allocator::default_reference) : buffer_capacity(Growth::initial), current(0), max(0), bytes(0), allocator(allocator)
 			{
+				storage.attach();
+			}
+			
+			JoiningBuffer(Storage storage, typename Allocator::Reference allocator = Allocator::default_reference) : buffer_capacity(Growth::initial), current(0), max(0), bytes(0), allocator(allocator), storage(storage)
+			{
+				this->storage.attach();
 			}
 			
 			~JoiningBuffer()
 			{
-				if(!Allocator::can_free)
-					return;
+				free_list(buffer_list);
+				free_list(spare_list);
+				storage.detach();
+			}
+			
+			void reset()
+			{
+				if(!Storage::reusable)
+					free_list(buffer_list);
 				
-				typename List<Buffer>::Iterator buffer = buffer_list.begin();
-
-				while(buffer != buffer_list.end())
+				if(buffer_list.first)
 				{
-					Buffer *current = *buffer;
-					++buffer;
-					allocator.free(current);
-				};
+					if(spare_list.last)
+						spare_list.last->entry.next = buffer_list.first;
+					else
+						spare_list.first = buffer_list.first;
+					
+					spare_list.last = buffer_list.last;
+				}
+				
+				buffer_list.clear();
+				current = 0;
+				max = 0;
+				bytes = 0;
+			}
+			
+			void trim()
+			{
+				if(Allocator::can_free)
+					free_list(spare_list);
 			}
 			
 			size_t size()
@@ -79,14 +227,161 @@ namespace Prelude
 				
 				prelude_runtime_assert(result != 0);
 				
-				auto pos = (uint8_t *)result;
+				compact_into(result, bytes);
+				
+				return result;
+			}
+			
+			bool compact_into(void *target, size_t capacity)
+			{
+				update();
+				
+				if(capacity < bytes)
+					return false;
+				
+				auto pos = (uint8_t *)target;
 				
 				for(Buffer *buffer: buffer_list)
 				{
-					std::memcpy(pos, buffer + 1, buffer->size);
+					std::memcpy(pos, Storage::data(buffer), buffer->size);
 					pos += buffer->size;
 				}
 				
+				return true;
+			}
+			
+			template<typename F> bool each_segment(F func)
+			{
+				update();
+				
+				for(Buffer *buffer: buffer_list)
+				{
+					if(buffer->size && !func((const void *)Storage::data(buffer), buffer->size))
+						return false;
+				}
+				
+				return true;
+			}
+			
+			size_t segments()
+			{
+				size_t result = 0;
+				
+				each_segment([&](const void *, size_t) -> bool {
+					result++;
+					return true;
+				});
+				
+				return result;
+			}
+			
+			#ifndef WIN32
+				size_t gather(struct iovec *vectors, size_t count)
+				{
+					size_t result = 0;
+				
+					each_segment([&](const void *data, size_t size) -> bool {
+						if(result == count)
+							return false;
+					
+						vectors[result].iov_base = (void *)data;
+						vectors[result].iov_len = size;
+						result++;
+					
+						return true;
+					});
+				
+					return result;
+				}
+				
+				template<typename F> bool write_segments(F write)
+				{
+					static const size_t batch = 64;
+				
+					struct iovec vectors[batch];
+				
+					update();
+				
+					Buffer *buffer = buffer_list.first;
+					size_t skip = 0;
+				
+					while(true)
+					{
+						while(buffer && buffer->size == skip)
+						{
+							buffer = buffer->entry.next;
+							skip = 0;
+						}
+					
+						if(!buffer)
+							return true;
+					
+						size_t count = 0;
+					
+						for(Buffer *segment = buffer; segment && count < batch; segment = segment->entry.next)
+						{
+							size_t offset = segment == buffer ? skip : 0;
+						
+							if(segment->size == offset)
+								continue;
+						
+							vectors[count].iov_base = Storage::data(segment) + offset;
+							vectors[count].iov_len = segment->size - offset;
+							count++;
+						}
+					
+						ssize_t written = write((const struct iovec *)vectors, (int)count);
+					
+						if(written < 0 && errno == EINTR)
+							continue;
+					
+						if(written <= 0)
+							return false;
+					
+						size_t remaining = (size_t)written;
+					
+						while(buffer && remaining >= buffer->size - skip)
+						{
+							remaining -= buffer->size - skip;
+							buffer = buffer->entry.next;
+							skip = 0;
+						}
+					
+						skip += remaining;
+					}
+				}
+				
+				bool write_to(int fd)
+				{
+					return write_segments([&](const struct iovec *vectors, int count) -> ssize_t {
+						return writev(fd, vectors, count);
+					});
+				}
+				
+				bool write_to(int fd, off_t offset)
+				{
+					return write_segments([&](const struct iovec *vectors, int count) -> ssize_t {
+						ssize_t result = pwritev(fd, vectors, count, offset);
+					
+						if(result > 0)
+							offset += result;
+					
+						return result;
+					});
+				}
+			#endif
+			
+			bool finalize()
+			{
+				update();
+				
+				bool result = storage.finalize(buffer_list, bytes);
+				
+				free_list(buffer_list);
+				current = 0;
+				max = 0;
+				bytes = 0;
+				
 				return result;
 			}
 			
@@ -160,5 +455,61 @@ namespace Prelude
 
 				return (void *)result;
 			}
+			
+			uint8_t *reserve(size_t bytes)
+			{
+				if((size_t)(max - current) < bytes)
+					next_buffer(bytes);
+				
+				return current;
+			}
+			
+			void commit(uint8_t *end)
+			{
+				prelude_debug_assert(end >= current && end <= max);
+				
+				bytes += end - current;
+				current = end;
+			}
+			
+			void write(const void *data, size_t size)
+			{
+				const uint8_t *source = (const uint8_t *)data;
+				
+				while(size)
+				{
+					size_t room = max - current;
+					
+					if(!room)
+					{
+						next_buffer(size);
+						room = max - current;
+					}
+					
+					size_t count = room < size ? room : size;
+					
+					std::memcpy(current, source, count);
+					
+					current += count;
+					bytes += count;
+					source += count;
+					size -= count;
+				}
+			}
+			
+			template<typename T> void write_le(T value)
+			{
+				commit(Encoding::write_le(reserve(sizeof(T)), value));
+			}
+			
+			void write_varint(uint64_t value)
+			{
+				commit(Encoding::write_varint(reserve(Encoding::varint_size(value)), value));
+			}
+			
+			void write_signed_varint(int64_t value)
+			{
+				write_varint(Encoding::zigzag(value));
+			}
 	};
 };
@@ -58,6 +58,7 @@ namespace Prelude
 			}
 			else
 			{
+				entry.prev = 0;
 				first = node;
 				last = node;
 			}
@@ -1,10 +1,11 @@
 #pragma once
 #include "Internal/Common.hpp"
 #include "Allocator/Array.hpp"
+#include "Hash.hpp"
 
 namespace Prelude
 {
-	template<class K, class V> class MapFunctions
+	template<class K, class V, class Hasher = Hash::Fibonacci> class MapFunctions
 	{
 		public:
 			struct Pair
@@ -16,7 +17,12 @@ namespace Prelude
 			
 			static size_t hash_key(K key)
 			{
-				return (size_t)key;
+				return Hasher::hash(key);
+			}
+			
+			static bool compare_key(K key, K other)
+			{
+				return key == other;
 			}
 
 			static V invalid_value()
@@ -34,83 +40,179 @@ namespace Prelude
 				Allocator(ref).free((void *)pair);
 			}
 	};
+	
+	template<class V, class Hasher = Hash::Bytes> class StringMapFunctions:
+		public MapFunctions<const char *, V, Hasher>
+	{
+		public:
+			static bool compare_key(const char *key, const char *other)
+			{
+				return std::strcmp(key, other) == 0;
+			}
+	};
 
-	template<class K, class V, class T = MapFunctions<K, V>, class BaseAllocator = Allocator::Standard, template<class, class> class ArrayWrapper = Allocator::Array> class Map
+	template<class K, class V, class T = MapFunctions<K, V>, class BaseAllocator = Allocator::Standard, template<class, class> class ArrayWrapper = Allocator::Array, bool incremental = false> class Map
 	{
 		private:
 			typedef ArrayWrapper<typename T::Pair *, BaseAllocator> Allocator;
 			typedef typename T::Pair Pair;
 			typedef typename Allocator::Storage Table;
 			
+			static const size_t migrate_buckets = 4;
+			
 			Table table;
 			Allocator allocator;
 			size_t mask;
 			size_t entries;
 			
-			bool store(Table table, size_t mask, K key, V value)
+			Table old_table;
+			size_t old_mask;
+			size_t migrated;
+			
+			Table allocate_table(size_t size)
+			{
+				Table table = allocator.allocate(size);
+				
+				if(!Allocator::null_references)
+					std::memset(&table[0], 0, size * sizeof(Pair *));
+				
+				return table;
+			}
+			
+			Pair **bucket(size_t hash)
+			{
+				if(incremental && old_table)
+				{
+					size_t index = hash & old_mask;
+					
+					if(index >= migrated)
+						return &old_table[index];
+				}
+				
+				return &table[hash & mask];
+			}
+			
+			Pair *find(K key)
 			{
-				size_t index = T::hash_key(key) & mask;
-				Pair *pair = table[index];
-				Pair *tail = pair;
+				Pair *pair = *bucket(T::hash_key(key));
 
 				while(pair)
 				{
-					if(pair->key == key)
-					{
-						pair->value = value;
-						return false;
-					}
-
-					tail = pair;
+					if(T::compare_key(pair->key, key))
+						return pair;
+					
 					pair = pair->next;
 				}
+
+				return 0;
+			}
+			
+			Pair *create(K key, V value)
+			{
+				Pair **slot = bucket(T::hash_key(key));
+				Pair *pair = T::template allocate_pair<BaseAllocator>(allocator.reference());
 				
-				pair = T::template allocate_pair<BaseAllocator>(allocator.reference());
 				pair->key = key;
 				pair->value = value;
+				pair->next = *slot;
+				
+				*slot = pair;
+				
+				return pair;
+			}
+			
+			void relink(Table from, size_t index)
+			{
+				Pair *pair = from[index];
+				
+				from[index] = 0;
 
-				if(tail)
-					tail->next = pair;
-				else
-					table[index] = pair;
-
-				pair->next = 0;
+				while(pair)
+				{
+					Pair *next = pair->next;
+					Pair **slot = &table[T::hash_key(pair->key) & mask];
+					
+					pair->next = *slot;
+					*slot = pair;
 
-				return true;
+					pair = next;
+				}
+			}
+			
+			void migrate(size_t buckets)
+			{
+				size_t end = migrated + buckets;
+				
+				if(end > old_mask + 1)
+					end = old_mask + 1;
+				
+				for(; migrated < end; ++migrated)
+					relink(old_table, migrated);
+				
+				if(migrated > old_mask)
+				{
+					allocator.free(old_table);
+					old_table = nullptr;
+				}
+			}
+			
+			void step()
+			{
+				if(incremental && old_table)
+					migrate(migrate_buckets);
 			}
 
-			void expand()
+			void split()
 			{
-				size_t size = (this->mask + 1) << 1;
-				size_t mask = size - 1;
+				size_t old_size = mask + 1;
+				size_t size = old_size << 1;
 
-				Table table = allocator.allocate(size);
-				
-				if(!Allocator::null_references)
-					std::memset(&table[0], 0, size * sizeof(Pair *));
+				table = allocator.reallocate(table, old_size, size);
+				mask = size - 1;
 
-				Pair **end = &this->table[0] + (this->mask + 1);
+				for(size_t i = old_size; i < size; ++i)
+					table[i] = 0;
 
-				for(Pair **slot = &this->table[0]; slot != end; ++slot)
+				for(size_t i = 0; i < old_size; ++i)
 				{
-					Pair *pair = *slot;
+					Pair *pair = table[i];
+					Pair **tails[2] = {&table[i], &table[i + old_size]};
 
 					while(pair)
 					{
-						Pair *next = pair->next;
-
-						store(table, mask, pair->key, pair->value);
-						
-						T::template free_pair<BaseAllocator>(allocator.reference(), pair);
+						Pair **&tail = tails[(T::hash_key(pair->key) & old_size) ? 1 : 0];
 
-						pair = next;
+						*tail = pair;
+						tail = &pair->next;
+						pair = pair->next;
 					}
+
+					*tails[0] = 0;
+					*tails[1] = 0;
 				}
+			}
 
-				allocator.free(this->table);
+			void expand()
+			{
+				if(!incremental)
+				{
+					split();
+					return;
+				}
+				
+				if(old_table)
+					migrate(old_mask + 1);
+				
+				old_table = this->table;
+				old_mask = this->mask;
+				migrated = 0;
+				
+				size_t size = (this->mask + 1) << 1;
 
-				this->mask = mask;
-				this->table = table;
+				this->table = allocate_table(size);
+				this->mask = size - 1;
+				
+				migrate(migrate_buckets);
 			}
 
 			void increase()
@@ -120,56 +222,74 @@ namespace Prelude
 				if(prelude_unlikely(entries > mask))
 					expand();
 			}
+			
+			template<typename F> bool each_table_pair(Table table, size_t start, size_t mask, F func)
+			{
+				for(size_t i = start; i <= mask; ++i)
+				{
+					Pair *pair = table[i];
 
-		public:
-			typedef K Key;
-			typedef V Value;
+					while(pair)
+					{
+						Pair *next = pair->next;
+						
+						if(!func(pair))
+							return false;
+						
+						pair = next;
+					}
+				}
+				
+				return true;
+			}
 			
-			Map(typename Allocator::Reference allocator = Allocator::default_reference) : allocator(allocator)
+			template<typename F> bool each(F func)
+			{
+				if(incremental && old_table)
+				{
+					if(!each_table_pair(old_table, migrated, old_mask, func))
+						return false;
+				}
+				
+				return each_table_pair(table, 0, mask, func);
+			}
+			
+			void initialize(size_t initial)
 			{
 				entries = 0;
+				old_table = nullptr;
 
-				size_t size = 1 << initial;
+				size_t size = (size_t)1 << initial;
 				mask = size - 1;
 
-				table = this->allocator.allocate(size);
-				
-				if(!Allocator::null_references)
-					std::memset(&table[0], 0, size * sizeof(Pair *));
+				table = allocate_table(size);
 			}
 
-			Map(size_t initial, typename Allocator::Reference allocator = Allocator::default_reference) : allocator(allocator)
+		public:
+			typedef K Key;
+			typedef V Value;
+			
+			Map(typename Allocator::Reference allocator = Allocator::default_reference) : allocator(allocator)
 			{
-				entries = 0;
-
-				size_t size = 1 << initial;
-				mask = size - 1;
+				initialize(0);
+			}
 
-				table = this->allocator.allocate(size);
-				
-				if(!Allocator::null_references)
-					std::memset(&table[0], 0, size * sizeof(Pair *));
+			Map(size_t initial, typename Allocator::Reference allocator = Allocator::default_reference) : allocator(allocator)
+			{
+				initialize(initial);
 			}
 
 			~Map()
 			{
 				if(Allocator::can_free)
 				{
-					Pair **end = &table[0] + mask + 1;
-
-					for(Pair **slot = &table[0]; slot != end; ++slot)
-					{
-						Pair *pair = *slot;
-
-						while(pair)
-						{
-							Pair *next = pair->next;
-
-							T::template free_pair<typename Allocator::Base>(allocator.reference(), pair);
-
-							pair = next;
-						}
-					}
+					each([&](Pair *pair) -> bool {
+						T::template free_pair<typename Allocator::Base>(allocator.reference(), pair);
+						return true;
+					});
+					
+					if(incremental && old_table)
+						allocator.free(old_table);
 
 					allocator.free(table);
 				}
@@ -177,93 +297,67 @@ namespace Prelude
 
 			V get(K key)
 			{
-				size_t index = T::hash_key(key) & mask;
-				Pair *pair = table[index];
+				Pair *pair = find(key);
 
-				while(pair)
-				{
-					if(pair->key == key)
-						return pair->value;
-					
-					pair = pair->next;
-				}
+				if(pair)
+					return pair->value;
 
 				return T::invalid_value();
 			}
 			
 			template<typename func> V try_get(K key, func fails)
 			{
-				size_t index = T::hash_key(key) & mask;
-				Pair *pair = table[index];
+				Pair *pair = find(key);
 
-				while(pair)
-				{
-					if(pair->key == key)
-						return pair->value;
-					
-					pair = pair->next;
-				}
+				if(pair)
+					return pair->value;
 
 				return fails();
 			}
 			
 			template<typename func> bool each_pair(func do_for_pair)
 			{
-				for(size_t i = 0; i <= mask; ++i)
-				{
-					Pair *pair = table[i];
-
-					if(pair)
-					{
-						if(!do_for_pair(pair->key, pair->value))
-							return false;
-					}
-				}
-				
-				return true;
+				return each([&](Pair *pair) -> bool {
+					return do_for_pair(pair->key, pair->value);
+				});
 			}
 			
 			template<typename F> void mark_content(F mark)
 			{
 				for(size_t i = 0; i <= mask; ++i)
 				{
-					Pair *pair = table[i];
-					
-					if(pair)
+					if(table[i])
 						mark(table[i]);
 				}
+				
+				if(incremental && old_table)
+				{
+					for(size_t i = migrated; i <= old_mask; ++i)
+					{
+						if(old_table[i])
+							mark(old_table[i]);
+					}
+				}
 			}
 
 			template<typename F> void mark(F mark)
 			{
 				mark(table);
+				
+				if(incremental && old_table)
+					mark(old_table);
 			}
 
 			template<typename func> V get_create(K key, func create_value)
 			{
-				size_t index = T::hash_key(key) & mask;
-				Pair *pair = table[index];
-				Pair *tail = pair;
-
-				while(pair)
-				{
-					if(pair->key == key)
-						return pair->value;
-					
-					tail = pair;
-					pair = pair->next;
-				}
+				step();
 				
-				pair = T::allocate_pair(allocator.reference());
-				pair->key = key;
-				pair->value = create_value();
-
-				if(tail)
-					tail->next = pair;
-				else
-					table[index] = pair;
+				Pair *pair = find(key);
 
-				pair->next = 0;
+				if(pair)
+					return pair->value;
+				
+				pair = create(key, create_value());
 
 				increase();
 
@@ -272,16 +366,10 @@ namespace Prelude
 			
 			V *get_ref(K key)
 			{
-				size_t index = T::hash_key(key) & mask;
-				Pair *pair = table[index];
+				Pair *pair = find(key);
 
-				while(pair)
-				{
-					if(pair->key == key)
-						return &pair->value;
-					
-					pair = pair->next;
-				}
+				if(pair)
+					return &pair->value;
 
 				return 0;
 			}
@@ -293,24 +381,24 @@ namespace Prelude
 			
 			bool has(K key)
 			{
-				size_t index = T::hash_key(key) & mask;
-				Pair *pair = table[index];
-
-				while(pair)
-				{
-					if(pair->key == key)
-						return true;
-					
-					pair = pair->next;
-				}
-
-				return false;
+				return find(key) != 0;
 			}
 
 			void set(K key, V value)
 			{
-				if(store(table, mask, key, value))
-					increase();
+				step();
+				
+				Pair *pair = find(key);
+				
+				if(pair)
+				{
+					pair->value = value;
+					return;
+				}
+				
+				create(key, value);
+				
+				increase();
 			}
 			
 			typename Allocator::Reference get_allocator()
@@ -0,0 +1,207 @@
+#pragma once
+#include <stdint.h>
+#include "Internal/Common.hpp"
+
+#ifndef WIN32
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+#endif
+
+namespace Prelude
+{
+	#ifndef WIN32
+		struct MappedWindow
+		{
+			uint8_t *data;
+			size_t start;
+			size_t length;
+			size_t users;
+		};
+
+		/*
+		 * File which is extended on demand and mapped in windows. The length grows geometrically,
+		 * so the file should be truncated to its real size once it's complete.
+		 * map() carves ranges out of one window of at least window_size bytes, so writing a large file sequentially
+		 * takes few mappings. A window is unmapped once it's replaced and every range in it has been unmapped.
+		 */
+		class MappedFile
+		{
+			private:
+				static const size_t window_size = 0x4000000;
+
+				int fd;
+				bool owned;
+				bool attached;
+				size_t length;
+				size_t ranges;
+				MappedWindow *window;
+
+				static size_t page_size()
+				{
+					static size_t result = (size_t)sysconf(_SC_PAGESIZE);
+
+					return result;
+				}
+
+				void extend(size_t size)
+				{
+					if(size <= length)
+						return;
+
+					size_t result = length ? length : page_size();
+
+					while(result < size)
+						result <<= 1;
+
+					int status = ftruncate(fd, (off_t)result);
+
+					prelude_runtime_assert(status == 0);
+
+					length = result;
+				}
+
+				void release(MappedWindow *target)
+				{
+					munmap(target->data, target->length);
+
+					delete target;
+				}
+
+			public:
+				MappedFile(const char *path) : owned(true), attached(false), length(0), ranges(0), window(nullptr)
+				{
+					fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+					prelude_runtime_assert(fd != -1);
+				}
+
+				MappedFile(int fd) : fd(fd), owned(false), attached(false), ranges(0), window(nullptr)
+				{
+					off_t end = lseek(fd, 0, SEEK_END);
+
+					length = end > 0 ? (size_t)end : 0;
+				}
+
+				~MappedFile()
+				{
+					prelude_runtime_assert(!ranges);
+
+					if(window && !window->users)
+						release(window);
+
+					if(owned)
+						close(fd);
+				}
+
+				int descriptor()
+				{
+					return fd;
+				}
+
+				void attach()
+				{
+					prelude_runtime_assert(!attached);
+
+					attached = true;
+				}
+
+				void detach()
+				{
+					attached = false;
+				}
+
+				uint8_t *map(size_t offset, size_t size, MappedWindow *&result)
+				{
+					extend(offset + size);
+
+					if(!window || offset < window->start || offset + size > window->start + window->length)
+					{
+						if(window && !window->users)
+							release(window);
+
+						size_t start = align_down(offset, page_size());
+						size_t needed = align(offset + size - start, page_size());
+						size_t length = needed > window_size ? needed : window_size;
+
+						void *data = mmap(0, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, (off_t)start);
+
+						prelude_runtime_assert(data != MAP_FAILED);
+
+						window = new MappedWindow;
+						window->data = (uint8_t *)data;
+						window->start = start;
+						window->length = length;
+						window->users = 0;
+					}
+
+					window->users++;
+					ranges++;
+					result = window;
+
+					return window->data + (offset - window->start);
+				}
+
+				void unmap(MappedWindow *target)
+				{
+					ranges--;
+
+					if(!--target->users && target != window)
+						release(target);
+				}
+
+				bool write(const void *data, size_t size, size_t offset)
+				{
+					const uint8_t *source = (const uint8_t *)data;
+
+					while(size)
+					{
+						ssize_t written = pwrite(fd, source, size, (off_t)offset);
+
+						if(written < 0 && errno == EINTR)
+							continue;
+
+						if(written <= 0)
+							return false;
+
+						source += written;
+						offset += written;
+						size -= written;
+					}
+
+					return true;
+				}
+
+				bool move(size_t from, size_t to, size_t size)
+				{
+					uint8_t bounce[0x4000];
+
+					while(size)
+					{
+						size_t count = size < sizeof(bounce) ? size : sizeof(bounce);
+
+						size -= count;
+
+						if(pread(fd, bounce, count, (off_t)(from + size)) != (ssize_t)count)
+							return false;
+
+						if(!write(bounce, count, to + size))
+							return false;
+					}
+
+					return true;
+				}
+
+				bool truncate(size_t size)
+				{
+					if(ftruncate(fd, (off_t)size) != 0)
+						return false;
+
+					length = size;
+
+					return true;
+				}
+		};
+	#endif
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include <stdint.h>
+#include "Internal/Common.hpp"
+#include "List.hpp"
+#include "MappedFile.hpp"
+#include "JoiningBuffer.hpp"
+
+namespace Prelude
+{
+	#ifndef WIN32
+		namespace BufferStorage
+		{
+			/*
+			 * Each buffer is a range of the file at the current size(), carved from the file's current mapped window,
+			 * so the data is laid out in the file as it's written. finalize() then fixes up buffers inserted from
+			 * other files and truncates the file. Buffers are unmapped instead of reused by reset().
+			 * The JoiningBuffer attaches to the file as its only writer, and the file must outlive it and every JoiningBuffer
+			 * its buffers are inserted into.
+			 */
+			struct Mapped
+			{
+				struct Segment
+				{
+					uint8_t *data;
+					MappedFile *file;
+					MappedWindow *window;
+					size_t offset;
+				};
+
+				static const bool reusable = false;
+
+				MappedFile *file;
+
+				Mapped(MappedFile &file) : file(&file)
+				{
+				}
+
+				void attach()
+				{
+					file->attach();
+				}
+
+				void detach()
+				{
+					file->detach();
+				}
+
+				template<class Buffer> static uint8_t *data(Buffer *buffer)
+				{
+					return buffer->data;
+				}
+
+				template<class Buffer, class Allocator> Buffer *allocate(Allocator &allocator, size_t offset, size_t capacity)
+				{
+					Buffer *result = new (allocator.allocate(sizeof(Buffer))) Buffer;
+
+					result->data = file->map(offset, capacity, result->window);
+					result->file = file;
+					result->offset = offset;
+
+					return result;
+				}
+
+				template<class Buffer> void release(Buffer *buffer)
+				{
+					buffer->file->unmap(buffer->window);
+				}
+
+				template<class Buffer> bool finalize(List<Buffer> &list, size_t size)
+				{
+					Buffer *reversed = nullptr;
+
+					for(Buffer *buffer = list.first; buffer;)
+					{
+						Buffer *next = buffer->entry.next;
+
+						buffer->entry.next = reversed;
+						reversed = buffer;
+						buffer = next;
+					}
+
+					list.last = list.first;
+					list.first = reversed;
+
+					size_t position = size;
+					bool result = true;
+
+					for(Buffer *buffer = reversed; buffer; buffer = buffer->entry.next)
+					{
+						position -= buffer->size;
+
+						if(buffer->file != file)
+							result = file->write(buffer->data, buffer->size, position) && result;
+						else if(buffer->offset != position)
+							result = file->move(buffer->offset, position, buffer->size) && result;
+					}
+
+					return file->truncate(size) && result;
+				}
+			};
+		};
+
+		template<size_t buffer_size, typename Allocator = Allocator::Standard, class Growth = ChunkGrowth::Fixed<buffer_size> > using MappedJoiningBuffer = JoiningBuffer<buffer_size, Allocator, Growth, BufferStorage::Mapped>;
+	#endif
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <stdint.h>
+#include "../Internal/Common.hpp"
+#include "../ThreadPool.hpp"
+#include "../JoiningBuffer.hpp"
+
+namespace Prelude
+{
+	namespace Parallel
+	{
+		/*
+		 * Copy of up to grain bytes gathered from consecutive segments. Spawned into the pool's Group, so it lives in the worker's Region.
+		 */
+		struct SegmentCopy
+		{
+			static const size_t limit = 16;
+
+			uint8_t *target;
+			size_t count;
+			const uint8_t *data[limit];
+			size_t size[limit];
+
+			void operator ()() const
+			{
+				uint8_t *position = target;
+
+				for(size_t i = 0; i < count; ++i)
+				{
+					std::memcpy(position, data[i], size[i]);
+					position += size[i];
+				}
+			}
+		};
+
+		/*
+		 * JoiningBuffer::compact_into on the pool's workers. The calling worker walks the segments and spawns a copy
+		 * for every grain bytes, so small buffers are batched and large ones are split.
+		 */
+		template<size_t buffer_size, typename Allocator, class Growth, class Storage> bool compact_into(JoiningBuffer<buffer_size, Allocator, Growth, Storage> &buffer, void *target, size_t capacity, size_t grain = 0x100000, ThreadPool &pool = ThreadPool::standard())
+		{
+			if(capacity < buffer.size())
+				return false;
+
+			if(!grain)
+				grain = 1;
+
+			pool.run([&] {
+				ThreadPool::Group group(pool);
+				SegmentCopy copy;
+				size_t pending = 0;
+
+				copy.target = (uint8_t *)target;
+				copy.count = 0;
+
+				buffer.each_segment([&](const void *data, size_t size) -> bool {
+					const uint8_t *source = (const uint8_t *)data;
+
+					while(size)
+					{
+						size_t count = grain - pending < size ? grain - pending : size;
+
+						copy.data[copy.count] = source;
+						copy.size[copy.count] = count;
+						copy.count++;
+
+						pending += count;
+						source += count;
+						size -= count;
+
+						if(pending == grain || copy.count == SegmentCopy::limit)
+						{
+							group.spawn(copy);
+
+							copy.target += pending;
+							copy.count = 0;
+							pending = 0;
+						}
+					}
+
+					return true;
+				});
+
+				copy();
+
+				group.wait();
+			});
+
+			return true;
+		}
+	};
+};
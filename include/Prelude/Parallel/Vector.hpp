@@ -0,0 +1,117 @@
+#pragma once
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include "../Internal/Common.hpp"
+#include "../Internal/Parallel.hpp"
+#include "../Vector.hpp"
+
+namespace Prelude
+{
+	namespace Parallel
+	{
+		/*
+		 * Parallel algorithms for contiguous containers, that is anything with raw() and size() like Vector and SmallVector.
+		 * Kept out of Vector.hpp so only users of these pull in ThreadPool.
+		 */
+		template<class C, typename F> bool each(C &vector, F func, size_t grain = default_grain, ThreadPool &pool = ThreadPool::standard())
+		{
+			auto table = vector.raw();
+			std::atomic<bool> stop(false);
+
+			return for_blocks(vector.size(), grain, [&](size_t, size_t start, size_t end) -> bool {
+				for(size_t i = start; i < end; ++i)
+				{
+					if(stop.load(std::memory_order_relaxed))
+						return false;
+
+					if(!func(table[i]))
+					{
+						stop.store(true, std::memory_order_relaxed);
+						return false;
+					}
+				}
+
+				return true;
+			}, pool);
+		}
+
+		template<class C, typename F, typename T> T find(C &vector, F func, T default_value, size_t grain = default_grain, ThreadPool &pool = ThreadPool::standard())
+		{
+			auto table = vector.raw();
+			std::atomic<size_t> found((size_t)-1);
+
+			for_blocks(vector.size(), grain, [&](size_t, size_t start, size_t end) -> bool {
+				for(size_t i = start; i < end && i < found.load(std::memory_order_relaxed); ++i)
+				{
+					if(func(table[i]))
+					{
+						size_t current = found.load(std::memory_order_relaxed);
+
+						while(i < current && !found.compare_exchange_weak(current, i, std::memory_order_relaxed));
+
+						break;
+					}
+				}
+
+				return true;
+			}, pool);
+
+			size_t index = found.load();
+
+			return index == (size_t)-1 ? default_value : table[index];
+		}
+
+		template<class C, typename R, typename F, typename Combine> R reduce(C &vector, R identity, F func, Combine combine, size_t grain = default_grain, ThreadPool &pool = ThreadPool::standard())
+		{
+			auto table = vector.raw();
+			Vector<R> partial;
+
+			partial.expand_to(blocks(vector.size(), grain), identity);
+
+			for_blocks(vector.size(), grain, [&](size_t block, size_t start, size_t end) -> bool {
+				R result = identity;
+
+				for(size_t i = start; i < end; ++i)
+					result = func(result, table[i]);
+
+				partial[block] = std::move(result);
+
+				return true;
+			}, pool);
+
+			R result = identity;
+
+			for(size_t i = 0; i < partial.size(); ++i)
+				result = combine(result, partial[i]);
+
+			return result;
+		}
+
+		template<class C, typename Compare = std::less<typename std::remove_pointer<decltype(std::declval<C &>().raw())>::type> > void sort(C &vector, Compare compare = Compare(), size_t grain = default_grain, ThreadPool &pool = ThreadPool::standard())
+		{
+			auto start = vector.raw();
+			size_t size = vector.size();
+
+			for_blocks(size, grain, [&](size_t, size_t first, size_t last) -> bool {
+				std::sort(start + first, start + last, compare);
+
+				return true;
+			}, pool);
+
+			for(size_t width = grain; width < size; width <<= 1)
+			{
+				for_blocks(blocks(size, width << 1), 1, [&](size_t pair, size_t, size_t) -> bool {
+					size_t first = pair * (width << 1);
+					size_t middle = std::min(first + width, size);
+					size_t last = std::min(first + (width << 1), size);
+
+					if(middle < last)
+						std::inplace_merge(start + first, start + middle, start + last, compare);
+
+					return true;
+				}, pool);
+			}
+		}
+	};
+};
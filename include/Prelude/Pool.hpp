@@ -0,0 +1,195 @@
+#pragma once
+#include <stdint.h>
+#include "Internal/ChunkList.hpp"
+#include "LinkedList.hpp"
+#include "Allocator.hpp"
+
+namespace Prelude
+{
+	/*
+	 * Allocator for blocks of up to size bytes, carved from slabs and recycled through an embedded free list.
+	 * Larger requests, like the bucket array of a container using the pool, are passed on to Allocator and
+	 * aligned to large_align, which no slab block is handed out at, so free() can tell them apart by address.
+	 * Use it through Allocator::ReferenceTemplate.
+	 */
+	template<size_t size, typename Allocator = Allocator::Standard> class Pool
+	{
+		static const size_t block_size = size < sizeof(void *) ? sizeof(void *) : (size + memory_align - 1) & ~(memory_align - 1);
+		static const size_t slab_blocks = 0x1000 / block_size < 16 ? 16 : 0x1000 / block_size;
+
+		template<size_t bytes, size_t result = 0x1000, bool done = (result >= bytes)> struct Power
+		{
+			static const size_t value = Power<bytes, result * 2>::value;
+		};
+
+		template<size_t bytes, size_t result> struct Power<bytes, result, true>
+		{
+			static const size_t value = result;
+		};
+
+		static const size_t large_align = Power<block_size * slab_blocks>::value;
+
+		private:
+			struct Block
+			{
+				Block *next;
+			};
+
+			struct Large
+			{
+				LinkedListEntry<Large> entry;
+				void *base;
+			};
+
+			static const size_t large_overhead = sizeof(Large) + large_align;
+
+			ChunkList<Allocator> chunk_list;
+			Allocator allocator;
+			LinkedList<Large> large_list;
+			Block *free_list;
+
+			static bool is_large(void *memory)
+			{
+				return ((size_t)memory & (large_align - 1)) == 0;
+			}
+
+			void *get_slab()
+			{
+				uint8_t *slab = (uint8_t *)chunk_list.allocate(block_size * slab_blocks);
+
+				for(size_t i = slab_blocks; i-- > 0;)
+				{
+					Block *block = (Block *)(slab + i * block_size);
+
+					if(prelude_unlikely(is_large(block)))
+						continue;
+
+					block->next = free_list;
+					free_list = block;
+				}
+
+				Block *result = free_list;
+
+				free_list = result->next;
+
+				return (void *)result;
+			}
+
+			static uint8_t *large_data(void *base)
+			{
+				return (uint8_t *)align((size_t)base + sizeof(Large), large_align);
+			}
+
+			void *track_large(void *base, uint8_t *memory)
+			{
+				Large *large = new ((Large *)memory - 1) Large;
+
+				large->base = base;
+				large_list.append(large);
+
+				return memory;
+			}
+
+			void *allocate_large(size_t bytes)
+			{
+				void *base = allocator.allocate(large_overhead + bytes);
+
+				return track_large(base, large_data(base));
+			}
+
+			void free_large(void *memory)
+			{
+				Large *large = (Large *)memory - 1;
+
+				large_list.remove(large);
+				allocator.free(large->base);
+			}
+
+		public:
+			Pool(typename Allocator::Reference allocator = Allocator::default_reference) : chunk_list(allocator), allocator(allocator), free_list(nullptr)
+			{
+			}
+
+			~Pool()
+			{
+				if(!Allocator::can_free)
+					return;
+
+				Large *large = large_list.first;
+
+				while(large)
+				{
+					Large *next = large->entry.next;
+					allocator.free(large->base);
+					large = next;
+				}
+			}
+
+			static const bool can_free = true;
+			static const bool null_references = false;
+
+			void *allocate(size_t bytes)
+			{
+				if(prelude_unlikely(bytes > size))
+					return allocate_large(bytes);
+
+				Block *result = free_list;
+
+				if(prelude_unlikely(!result))
+					return get_slab();
+
+				free_list = result->next;
+
+				return (void *)result;
+			}
+
+			void *reallocate(void *memory, size_t old_size, size_t new_size)
+			{
+				if(old_size > size)
+				{
+					if(new_size > size)
+					{
+						Large *large = (Large *)memory - 1;
+						size_t offset = (size_t)memory - (size_t)large->base;
+
+						large_list.remove(large);
+
+						uint8_t *base = (uint8_t *)allocator.reallocate(large->base, large_overhead + old_size, large_overhead + new_size);
+						uint8_t *result = large_data(base);
+
+						if(result != base + offset)
+							std::memmove(result, base + offset, old_size < new_size ? old_size : new_size);
+
+						return track_large(base, result);
+					}
+				}
+				else if(new_size <= size)
+					return memory;
+
+				void *result = allocate(new_size);
+
+				std::memcpy(result, memory, old_size < new_size ? old_size : new_size);
+
+				free(memory);
+
+				return result;
+			}
+
+			void free(void *memory)
+			{
+				if(!memory)
+					return;
+
+				if(prelude_unlikely(is_large(memory)))
+				{
+					free_large(memory);
+					return;
+				}
+
+				Block *block = (Block *)memory;
+
+				block->next = free_list;
+				free_list = block;
+			}
+	};
+};
@@ -5,40 +5,136 @@
 
 namespace Prelude
 {
-	template<typename Allocator = StandardAllocator> class Region:
-		public WithReferenceProvider<Region<Allocator>>
+	template<typename Allocator = Allocator::Standard, class Growth = ChunkGrowth::Fixed<0x1000> > class Region
 	{
-		static const unsigned int max_alloc = 0x1000;
-
 		private:
-			ChunkList<Allocator> chunk_list;
+			struct Page
+			{
+				Page *next;
+				size_t size;
+			};
+
+			ChunkList<Allocator, Growth> chunk_list;
+
+			Page *pages;
+			Page *spare;
 
 			uint8_t *current;
 			uint8_t *max;
+			uint8_t *last;
 
-			uint8_t *allocate_page(size_t bytes = max_alloc);
+			Page *push_page(size_t bytes, bool grow)
+			{
+				Page **slot = &spare;
+
+				while(*slot && (*slot)->size < bytes)
+					slot = &(*slot)->next;
+
+				Page *page = *slot;
+
+				if(page)
+					*slot = page->next;
+				else if(grow)
+				{
+					size_t size;
+					
+					page = new (chunk_list.allocate_page(size)) Page;
+					page->size = size - sizeof(Page);
+				}
+				else
+				{
+					page = new (chunk_list.allocate(sizeof(Page) + bytes)) Page;
+					page->size = bytes;
+				}
+
+				page->next = pages;
+				pages = page;
+
+				return page;
+			}
 
 			void *get_page(size_t bytes)
 			{
-				if(bytes > max_alloc)
-					return chunk_list.allocate(bytes);
+				if(bytes + sizeof(Page) > chunk_list.page_size())
+					return push_page(bytes, false) + 1;
 
-				uint8_t *result = (uint8_t *)chunk_list.allocate(max_alloc);
+				Page *page = push_page(bytes, true);
+				uint8_t *result = (uint8_t *)(page + 1);
 
-				max = result + max_alloc;
+				max = result + page->size;
 
 				result = (uint8_t *)align((size_t)result, memory_align);
 
 				current = result + bytes;
+				last = result;
 		
 				return result;
 			}
 		public:
-			Region(typename Allocator::Ref::Type allocator = Allocator::Ref::standard) : chunk_list(allocator), current(0), max(0)
+			struct Savepoint
+			{
+				Page *pages;
+				uint8_t *current;
+				uint8_t *max;
+			};
+
+			class Scope
+			{
+				private:
+					Region &region;
+					Savepoint point;
+
+				public:
+					Scope(Region &region) : region(region), point(region.savepoint()) {}
+
+					~Scope()
+					{
+						region.rollback(point);
+					}
+			};
+
+			Region(typename Allocator::Reference allocator = Allocator::default_reference) : chunk_list(allocator), pages(0), spare(0), current(0), max(0), last(0)
 			{
 			}
 			
+			Savepoint savepoint()
+			{
+				Savepoint result;
+
+				result.pages = pages;
+				result.current = current;
+				result.max = max;
+
+				return result;
+			}
+
+			void rollback(const Savepoint &point)
+			{
+				while(pages != point.pages)
+				{
+					prelude_debug_assert(pages != 0);
+
+					Page *page = pages;
+
+					pages = page->next;
+					page->next = spare;
+					spare = page;
+				}
+
+				current = point.current;
+				max = point.max;
+				last = 0;
+			}
+
+			void reset()
+			{
+				Savepoint start = {0, 0, 0};
+
+				rollback(start);
+			}
+
 			static const bool can_free = false;
+			static const bool null_references = false;
 
 			void *allocate(size_t bytes)
 			{
@@ -52,13 +148,22 @@ namespace Prelude
 					return get_page(bytes);
 
 				current = next;
+				last = result;
 
 				return (void *)result;
 			}
 			
 			void *reallocate(void *memory, size_t old_size, size_t new_size)
 			{
-				// TODO: Check if this was the previous memory block allocated and try to expand the area.
+				if(memory == last && (uint8_t *)memory + new_size <= max)
+				{
+					current = (uint8_t *)memory + new_size;
+					
+					return memory;
+				}
+				
+				if(new_size <= old_size)
+					return memory;
 
 				void *result = allocate(new_size);
 				
@@ -67,26 +172,26 @@ namespace Prelude
 				return result;
 			}
 	
-			void free(void *memory)
+			void free(void *)
 			{
 			}
 	};
 };
 
-template<typename Allocator> inline void *operator new(size_t bytes, Prelude::Region<Allocator> &region) throw()
+template<typename Allocator, class Growth> inline void *operator new(size_t bytes, Prelude::Region<Allocator, Growth> &region) throw()
 {
 	return region.allocate(bytes);
 }
 
-template<typename Allocator> inline void operator delete(void *, Prelude::Region<Allocator> &region) throw()
+template<typename Allocator, class Growth> inline void operator delete(void *, Prelude::Region<Allocator, Growth> &region) throw()
 {
 }
 
-template<typename Allocator> inline void *operator new[](size_t bytes, Prelude::Region<Allocator> &region) throw()
+template<typename Allocator, class Growth> inline void *operator new[](size_t bytes, Prelude::Region<Allocator, Growth> &region) throw()
 {
 	return region.allocate(bytes);
 }
 
-template<typename Allocator> inline void operator delete[](void *, Prelude::Region<Allocator> &region) throw()
+template<typename Allocator, class Growth> inline void operator delete[](void *, Prelude::Region<Allocator, Growth> &region) throw()
 {
 }
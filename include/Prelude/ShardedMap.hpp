@@ -0,0 +1,148 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include "Internal/Common.hpp"
+#include "Internal/Parallel.hpp"
+#include "Map.hpp"
+
+namespace Prelude
+{
+	/*
+	 * Map split into 1 << shard_bits independently locked shards. The shard is picked from the high bits of the mixed hash,
+	 * leaving the low bits to the shard's own bucket index. Every shard owns an instance of BaseAllocator::Base
+	 * (a Region for ReferenceTemplate<Region<>>) so shards don't share an allocator either.
+	 */
+	template<class K, class V, size_t shard_bits = 4, class T = MapFunctions<K, V>, class BaseAllocator = Allocator::Standard, template<class, class> class ArrayWrapper = Allocator::Array> class ShardedMap
+	{
+		public:
+			static const size_t shards = (size_t)1 << shard_bits;
+
+			static_assert(shard_bits < 64, "shard_bits must leave some hash bits to the shards");
+
+			typedef K Key;
+			typedef V Value;
+			typedef Map<K, V, T, BaseAllocator, ArrayWrapper> ShardMap;
+
+		private:
+			prelude_align(struct, Shard, 64)
+			{
+				std::mutex lock;
+				typename BaseAllocator::Base allocator;
+				ShardMap map;
+
+				Shard() : map(BaseAllocator(allocator).reference()) {}
+			};
+
+			Shard shard_list[shards];
+
+			Shard &shard(K key)
+			{
+				uint64_t hash = (uint64_t)T::hash_key(key) * 0x9E3779B97F4A7C15ull;
+
+				return shard_list[(size_t)((hash >> 1) >> (63 - shard_bits))];
+			}
+
+		public:
+			V get(K key)
+			{
+				Shard &shard = this->shard(key);
+				std::lock_guard<std::mutex> guard(shard.lock);
+
+				return shard.map.get(key);
+			}
+
+			template<typename func> V try_get(K key, func fails)
+			{
+				Shard &shard = this->shard(key);
+				std::lock_guard<std::mutex> guard(shard.lock);
+
+				return shard.map.try_get(key, fails);
+			}
+
+			template<typename func> V get_create(K key, func create_value)
+			{
+				Shard &shard = this->shard(key);
+				std::lock_guard<std::mutex> guard(shard.lock);
+
+				return shard.map.get_create(key, create_value);
+			}
+
+			bool has(K key)
+			{
+				Shard &shard = this->shard(key);
+				std::lock_guard<std::mutex> guard(shard.lock);
+
+				return shard.map.has(key);
+			}
+
+			void set(K key, V value)
+			{
+				Shard &shard = this->shard(key);
+				std::lock_guard<std::mutex> guard(shard.lock);
+
+				shard.map.set(key, value);
+			}
+
+			size_t get_entries()
+			{
+				size_t result = 0;
+
+				for(size_t i = 0; i < shards; ++i)
+				{
+					std::lock_guard<std::mutex> guard(shard_list[i].lock);
+
+					result += shard_list[i].map.get_entries();
+				}
+
+				return result;
+			}
+
+			template<typename func> bool each_pair(func do_for_pair)
+			{
+				for(size_t i = 0; i < shards; ++i)
+				{
+					std::lock_guard<std::mutex> guard(shard_list[i].lock);
+
+					if(!shard_list[i].map.each_pair(do_for_pair))
+						return false;
+				}
+
+				return true;
+			}
+
+			template<typename func> bool parallel_each_pair(func do_for_pair, ThreadPool &pool = ThreadPool::standard())
+			{
+				std::atomic<bool> stop(false);
+
+				return Parallel::for_blocks(shards, 1, [&](size_t i, size_t, size_t) -> bool {
+					std::lock_guard<std::mutex> guard(shard_list[i].lock);
+
+					bool result = shard_list[i].map.each_pair([&](K key, V value) -> bool {
+						return !stop.load(std::memory_order_relaxed) && do_for_pair(key, value);
+					});
+
+					if(!result)
+						stop.store(true, std::memory_order_relaxed);
+
+					return result;
+				}, pool);
+			}
+
+			template<typename F> void mark_content(F mark)
+			{
+				for(size_t i = 0; i < shards; ++i)
+				{
+					std::lock_guard<std::mutex> guard(shard_list[i].lock);
+
+					shard_list[i].map.mark_content(mark);
+				}
+			}
+
+			template<typename F> void mark(F mark)
+			{
+				for(size_t i = 0; i < shards; ++i)
+					shard_list[i].map.mark(mark);
+			}
+	};
+};
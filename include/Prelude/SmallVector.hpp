@@ -0,0 +1,403 @@
+#pragma once
+#include "Vector.hpp"
+
+namespace Prelude
+{
+	/*
+	 * Vector which keeps up to N elements in the object itself and only uses the allocator beyond that.
+	 */
+	template<class T, size_t N, class BaseAllocator = Allocator::Standard, template<class, class> class ArrayWrapper = Allocator::Array> class SmallVector
+	{
+		protected:
+			typedef ArrayWrapper<T, BaseAllocator> Allocator;
+
+			typename Allocator::Storage table;
+			Allocator allocator;
+			T *data;
+			size_t _size;
+			size_t _capacity;
+			typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type storage;
+
+			T *inline_data()
+			{
+				return (T *)&storage;
+			}
+
+			void reset()
+			{
+				table = nullptr;
+				data = inline_data();
+				_size = 0;
+				_capacity = N;
+			}
+
+			void destroy(size_t start, size_t end)
+			{
+				if(!std::is_trivially_destructible<T>::value)
+					for(size_t i = start; i < end; ++i)
+						data[i].~T();
+			}
+
+			void relocate(size_t to, size_t from)
+			{
+				new (&data[to]) T(std::move(data[from]));
+				data[from].~T();
+			}
+
+			void relocate_range(size_t to, size_t from, size_t count)
+			{
+				if(TriviallyRelocatable<T>::value)
+					std::memmove((void *)&data[to], (void *)&data[from], sizeof(T) * count);
+				else if(to < from)
+					for(size_t i = 0; i < count; ++i)
+						relocate(to + i, from + i);
+				else
+					for(size_t i = count; i-- > 0;)
+						relocate(to + i, from + i);
+			}
+
+			static void move_entries(T *to, T *from, size_t count)
+			{
+				if(TriviallyRelocatable<T>::value)
+					std::memcpy((void *)to, (void *)from, sizeof(T) * count);
+				else
+					for(size_t i = 0; i < count; ++i)
+					{
+						new (&to[i]) T(std::move(from[i]));
+						from[i].~T();
+					}
+			}
+
+			void release()
+			{
+				destroy(0, _size);
+
+				if(table)
+					allocator.free(table);
+			}
+
+			void take(SmallVector &other)
+			{
+				if(other.table)
+				{
+					table = other.table;
+					data = &table[0];
+					_capacity = other._capacity;
+				}
+				else
+				{
+					table = nullptr;
+					data = inline_data();
+					_capacity = N;
+
+					move_entries(data, other.data, other._size);
+				}
+
+				_size = other._size;
+
+				other.reset();
+			}
+
+			template<class Other> void initialize_copy(const Other &other)
+			{
+				reset();
+
+				expand(other.size());
+
+				for(size_t i = 0; i < other.size(); ++i)
+					new (&data[i]) T(other[i]);
+
+				_size = other.size();
+			}
+
+		public:
+			typedef typename Vector<T, BaseAllocator, ArrayWrapper>::Iterator Iterator;
+			typedef typename Vector<T, BaseAllocator, ArrayWrapper>::ReverseIterator ReverseIterator;
+
+			SmallVector(typename Allocator::Reference allocator = Allocator::default_reference) : allocator(allocator)
+			{
+				reset();
+			}
+
+			SmallVector(SmallVector &&vector) : allocator(vector.allocator)
+			{
+				take(vector);
+			}
+
+			SmallVector(const SmallVector &vector) : allocator(vector.allocator)
+			{
+				initialize_copy(vector);
+			}
+
+			~SmallVector()
+			{
+				release();
+			}
+
+			SmallVector &operator=(const SmallVector &other)
+			{
+				if(this == &other)
+					return *this;
+
+				release();
+
+				initialize_copy(other);
+
+				return *this;
+			}
+
+			SmallVector &operator=(SmallVector &&other)
+			{
+				if(this == &other)
+					return *this;
+
+				release();
+
+				allocator = other.allocator.reference();
+
+				take(other);
+
+				return *this;
+			}
+
+			void expand(size_t num)
+			{
+				if(prelude_likely(_size + num <= _capacity))
+					return;
+
+				size_t capacity = _capacity ? _capacity : 1;
+
+				while(_size + num > capacity)
+					capacity <<= 1;
+
+				if(table && TriviallyRelocatable<T>::value)
+					table = allocator.reallocate(table, _size, capacity);
+				else
+				{
+					typename Allocator::Storage old = table;
+					typename Allocator::Storage next = allocator.allocate(capacity);
+
+					move_entries(&next[0], data, _size);
+
+					if(old)
+						allocator.free(old);
+
+					table = next;
+				}
+
+				data = &table[0];
+				_capacity = capacity;
+			}
+
+			bool is_inline() const
+			{
+				return table == nullptr;
+			}
+
+			template<typename F> void mark_content(F mark)
+			{
+				for(size_t i = 0; i < _size; ++i)
+					mark(data[i]);
+			}
+
+			template<typename F> void mark(F mark)
+			{
+				if(table)
+					mark(table);
+			}
+
+			size_t size() const
+			{
+				return _size;
+			}
+
+			size_t capacity() const
+			{
+				return _capacity;
+			}
+
+			const T &first() const
+			{
+				prelude_debug_assert(_size > 0);
+
+				return data[0];
+			}
+
+			T &first()
+			{
+				prelude_debug_assert(_size > 0);
+
+				return data[0];
+			}
+
+			T *raw() const
+			{
+				return data;
+			}
+
+			T &last()
+			{
+				prelude_debug_assert(_size > 0);
+
+				return data[_size - 1];
+			}
+
+			T &operator [](size_t index)
+			{
+				prelude_debug_assert(index < _size);
+
+				return data[index];
+			}
+
+			const T &operator [](size_t index) const
+			{
+				prelude_debug_assert(index < _size);
+
+				return data[index];
+			}
+
+			void clear()
+			{
+				release();
+				reset();
+			}
+
+			T shift()
+			{
+				T result = std::move(first());
+
+				remove(0);
+
+				return result;
+			}
+
+			void remove(size_t index)
+			{
+				prelude_debug_assert(index < _size);
+
+				_size -= 1;
+
+				data[index].~T();
+
+				relocate_range(index, index + 1, _size - index);
+			}
+
+			void push_entries_front(T *entries, size_t count)
+			{
+				expand(count);
+
+				relocate_range(count, 0, _size);
+
+				for(size_t i = 0; i < count; ++i)
+					new (&data[i]) T(entries[i]);
+
+				_size += count;
+			}
+
+			void push_entries(T *entries, size_t count)
+			{
+				expand(count);
+
+				for(size_t i = 0; i < count; ++i)
+					new (&data[_size + i]) T(entries[i]);
+
+				_size += count;
+			}
+
+			void push(T entry)
+			{
+				expand(1);
+
+				new (&data[_size]) T(std::move(entry));
+
+				_size++;
+			}
+
+			template<typename... Args> T &emplace(Args&&... args)
+			{
+				expand(1);
+
+				T *result = new (&data[_size]) T(std::forward<Args>(args)...);
+
+				_size++;
+
+				return *result;
+			}
+
+			T pop()
+			{
+				prelude_debug_assert(_size);
+
+				_size -= 1;
+
+				T result = std::move(data[_size]);
+
+				data[_size].~T();
+
+				if(_size == 0 && table)
+				{
+					allocator.free(table);
+					reset();
+				}
+
+				return result;
+			}
+
+			size_t index_of(T entry)
+			{
+				T *result = find(entry);
+
+				if(!result)
+					return (size_t)-1;
+
+				return (size_t)(result - raw());
+			}
+
+			template<typename F> bool each(F func)
+			{
+				for(size_t i = 0; i < _size; ++i)
+				{
+					if(!func(data[i]))
+						return false;
+				}
+
+				return true;
+			}
+
+			template<typename F> T find(F func, T default_value)
+			{
+				for(size_t i = 0; i < _size; ++i)
+				{
+					if(func(data[i]))
+						return data[i];
+				}
+
+				return default_value;
+			}
+
+			T *find(T entry)
+			{
+				return (T *)Search::find(data, _size, entry);
+			}
+
+			Iterator begin()
+			{
+				return Iterator(data);
+			}
+
+			Iterator end()
+			{
+				return Iterator(data + _size);
+			}
+
+			ReverseIterator rbegin()
+			{
+				return ReverseIterator(data + _size - 1);
+			}
+
+			ReverseIterator rend()
+			{
+				return ReverseIterator(data - 1);
+			}
+	};
+};
@@ -0,0 +1,404 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "Internal/Common.hpp"
+#include "Internal/WorkDeque.hpp"
+#include "Region.hpp"
+
+namespace Prelude
+{
+	/*
+	 * Fixed set of worker threads, each with a Chase-Lev deque of tasks. Idle workers steal from the top of
+	 * other deques and sleep once there is nothing left. Tasks spawned in a Group are allocated from the
+	 * spawning worker's Region, which is rolled back when the Group has been joined.
+	 */
+	class ThreadPool
+	{
+		private:
+			struct Worker;
+
+			template<int dummy = 0> struct State
+			{
+				static prelude_thread Worker *current;
+			};
+
+			class Task
+			{
+				public:
+					Task *next;
+					std::atomic<size_t> *pending;
+					bool root;
+
+					Task(std::atomic<size_t> *pending, bool root = false) : next(nullptr), pending(pending), root(root) {}
+
+					virtual ~Task() {}
+
+					virtual void run() = 0;
+			};
+
+			template<typename F> class FunctionTask:
+				public Task
+			{
+				private:
+					F func;
+
+				public:
+					FunctionTask(std::atomic<size_t> *pending, F func, bool root = false) : Task(pending, root), func(std::move(func)) {}
+
+					void run()
+					{
+						func();
+					}
+			};
+
+			prelude_align(struct, Worker, 64)
+			{
+				ThreadPool *pool;
+				size_t index;
+				size_t seed;
+				WorkDeque<Task *> deque;
+				Region<> arena;
+				std::thread thread;
+			};
+
+			static const size_t spin_limit = 64;
+
+			void *memory;
+			Worker *workers;
+			size_t count;
+			std::mutex lock;
+			std::condition_variable wake;
+			std::condition_variable finished;
+			std::atomic<size_t> epoch;
+			std::atomic<size_t> sleepers;
+			std::atomic<bool> stopping;
+			std::atomic<size_t> injected;
+			Task *injected_first;
+			Task *injected_last;
+
+			Worker *local()
+			{
+				Worker *worker = State<>::current;
+
+				return worker && worker->pool == this ? worker : nullptr;
+			}
+
+			void notify()
+			{
+				epoch.fetch_add(1, std::memory_order_seq_cst);
+
+				if(sleepers.load(std::memory_order_seq_cst))
+				{
+					std::lock_guard<std::mutex> guard(lock);
+
+					wake.notify_one();
+				}
+			}
+
+			void inject(Task *task)
+			{
+				{
+					std::lock_guard<std::mutex> guard(lock);
+
+					if(injected_last)
+						injected_last->next = task;
+					else
+						injected_first = task;
+
+					injected_last = task;
+
+					injected.fetch_add(1, std::memory_order_relaxed);
+				}
+
+				notify();
+			}
+
+			Task *take_injected()
+			{
+				if(!injected.load(std::memory_order_relaxed))
+					return nullptr;
+
+				std::lock_guard<std::mutex> guard(lock);
+
+				Task *result = injected_first;
+
+				if(result)
+				{
+					injected_first = result->next;
+
+					if(!injected_first)
+						injected_last = nullptr;
+
+					injected.fetch_sub(1, std::memory_order_relaxed);
+				}
+
+				return result;
+			}
+
+			Task *steal(Worker &worker)
+			{
+				worker.seed ^= worker.seed << 13;
+				worker.seed ^= worker.seed >> 7;
+				worker.seed ^= worker.seed << 17;
+
+				size_t start = worker.seed % count;
+
+				for(size_t i = 0; i < count; ++i)
+				{
+					Worker &victim = workers[(start + i) % count];
+
+					if(&victim == &worker)
+						continue;
+
+					Task *result = victim.deque.steal();
+
+					if(result)
+						return result;
+				}
+
+				return nullptr;
+			}
+
+			void execute(Task *task)
+			{
+				std::atomic<size_t> *pending = task->pending;
+				bool root = task->root;
+
+				task->run();
+				task->~Task();
+
+				if(root)
+				{
+					std::lock_guard<std::mutex> guard(lock);
+
+					pending->fetch_sub(1, std::memory_order_release);
+
+					finished.notify_all();
+				}
+				else
+					pending->fetch_sub(1, std::memory_order_release);
+			}
+
+			bool work_once(Worker &worker)
+			{
+				Task *task = worker.deque.pop();
+
+				if(!task)
+					task = steal(worker);
+
+				if(!task)
+					task = take_injected();
+
+				if(!task)
+					return false;
+
+				execute(task);
+
+				return true;
+			}
+
+			void work(Worker &worker)
+			{
+				State<>::current = &worker;
+
+				size_t idle = 0;
+
+				while(true)
+				{
+					size_t seen = epoch.load(std::memory_order_seq_cst);
+
+					if(work_once(worker))
+					{
+						idle = 0;
+						continue;
+					}
+
+					if(stopping.load(std::memory_order_acquire))
+						break;
+
+					if(++idle < spin_limit)
+					{
+						std::this_thread::yield();
+						continue;
+					}
+
+					sleepers.fetch_add(1, std::memory_order_seq_cst);
+
+					{
+						std::unique_lock<std::mutex> guard(lock);
+
+						wake.wait(guard, [&] {
+							return epoch.load(std::memory_order_seq_cst) != seen || stopping.load(std::memory_order_acquire);
+						});
+					}
+
+					sleepers.fetch_sub(1, std::memory_order_relaxed);
+
+					idle = 0;
+				}
+
+				State<>::current = nullptr;
+			}
+
+			template<typename F> void split(size_t start, size_t end, size_t grain, F &func)
+			{
+				Group group(*this);
+
+				while(end - start > grain)
+				{
+					size_t middle = start + (end - start) / 2;
+
+					group.spawn([=, &func] {
+						split(middle, end, grain, func);
+					});
+
+					end = middle;
+				}
+
+				func(start, end);
+
+				group.wait();
+			}
+
+		public:
+			/*
+			 * Fork/join scope. Must be created on a worker thread, that is inside run() or a spawned task.
+			 */
+			class Group
+			{
+				private:
+					ThreadPool &pool;
+					Worker *worker;
+					std::atomic<size_t> pending;
+					Region<>::Savepoint point;
+
+				public:
+					Group(ThreadPool &pool) : pool(pool), worker(pool.local()), pending(0)
+					{
+						prelude_runtime_assert(worker && "Groups can only be used on the pool's worker threads");
+
+						point = worker->arena.savepoint();
+					}
+
+					~Group()
+					{
+						wait();
+					}
+
+					template<typename F> void spawn(F func)
+					{
+						Task *task = new (worker->arena) FunctionTask<F>(&pending, std::move(func));
+
+						pending.fetch_add(1, std::memory_order_relaxed);
+
+						worker->deque.push(task);
+
+						pool.notify();
+					}
+
+					void wait()
+					{
+						while(pending.load(std::memory_order_acquire))
+						{
+							if(!pool.work_once(*worker))
+								std::this_thread::yield();
+						}
+
+						worker->arena.rollback(point);
+					}
+			};
+
+			ThreadPool(size_t threads = std::thread::hardware_concurrency()) : epoch(0), sleepers(0), stopping(false), injected(0), injected_first(nullptr), injected_last(nullptr)
+			{
+				count = threads ? threads : 1;
+				memory = ::operator new(sizeof(Worker) * count + 64);
+				workers = (Worker *)align((size_t)memory, 64);
+
+				for(size_t i = 0; i < count; ++i)
+				{
+					new (&workers[i]) Worker;
+
+					workers[i].pool = this;
+					workers[i].index = i;
+					workers[i].seed = 0x9E3779B97F4A7C15ull * (i + 1);
+				}
+
+				for(size_t i = 0; i < count; ++i)
+					workers[i].thread = std::thread([this, i] {
+						work(workers[i]);
+					});
+			}
+
+			~ThreadPool()
+			{
+				stopping.store(true, std::memory_order_release);
+
+				{
+					std::lock_guard<std::mutex> guard(lock);
+
+					wake.notify_all();
+				}
+
+				for(size_t i = 0; i < count; ++i)
+					workers[i].thread.join();
+
+				for(size_t i = 0; i < count; ++i)
+					workers[i].~Worker();
+
+				::operator delete(memory);
+			}
+
+			static ThreadPool &standard()
+			{
+				static ThreadPool pool;
+
+				return pool;
+			}
+
+			size_t threads() const
+			{
+				return count;
+			}
+
+			template<typename F> void run(F func)
+			{
+				if(local())
+				{
+					func();
+					return;
+				}
+
+				std::atomic<size_t> pending(1);
+				Task *task = new FunctionTask<F>(&pending, std::move(func), true);
+
+				inject(task);
+
+				{
+					std::unique_lock<std::mutex> guard(lock);
+
+					finished.wait(guard, [&] {
+						return pending.load(std::memory_order_acquire) == 0;
+					});
+				}
+
+				::operator delete(task);
+			}
+
+			template<typename F> void parallel_for(size_t start, size_t end, size_t grain, F func)
+			{
+				if(start >= end)
+					return;
+
+				if(!grain)
+					grain = 1;
+
+				run([&] {
+					split(start, end, grain, func);
+				});
+			}
+	};
+
+	template<int dummy> prelude_thread ThreadPool::Worker *ThreadPool::State<dummy>::current = nullptr;
+};
@@ -1,9 +1,22 @@
 #pragma once
+#include <new>
+#include <utility>
+#include <type_traits>
 #include "Internal/Common.hpp"
+#include "Internal/Search.hpp"
 #include "Allocator/Array.hpp"
 
 namespace Prelude
 {
+	/*
+	 * Types which can be moved to a new address with memcpy. Specialize for types which own
+	 * resources but don't point into themselves to let Vector grow them with reallocate.
+	 */
+	template<class T> struct TriviallyRelocatable
+	{
+		static const bool value = std::is_trivially_copyable<T>::value;
+	};
+
 	template<class T, class BaseAllocator = Allocator::Standard, template<class, class> class ArrayWrapper = Allocator::Array> class Vector
 	{
 		protected:
@@ -23,13 +36,60 @@ namespace Prelude
 				{
 					table = allocator.allocate(_capacity);
 
-					std::memcpy((void *)raw(), (void *)other.raw(), sizeof(T) * _size);
+					if(std::is_trivially_copyable<T>::value)
+						std::memcpy((void *)raw(), (void *)other.raw(), sizeof(T) * _size);
+					else
+						for(size_t i = 0; i < _size; ++i)
+							new (&table[i]) T(other[i]);
 				}
 				else
 				{
 					table = nullptr;
 				}
 			}
+			
+			void destroy(size_t start, size_t end)
+			{
+				if(!std::is_trivially_destructible<T>::value)
+					for(size_t i = start; i < end; ++i)
+						table[i].~T();
+			}
+			
+			void relocate(size_t to, size_t from)
+			{
+				new (&table[to]) T(std::move(table[from]));
+				table[from].~T();
+			}
+			
+			void relocate_range(size_t to, size_t from, size_t count)
+			{
+				if(TriviallyRelocatable<T>::value)
+					std::memmove((void *)&table[to], (void *)&table[from], sizeof(T) * count);
+				else if(to < from)
+					for(size_t i = 0; i < count; ++i)
+						relocate(to + i, from + i);
+				else
+					for(size_t i = count; i-- > 0;)
+						relocate(to + i, from + i);
+			}
+			
+			void copy_entries(size_t to, const T *entries, size_t count)
+			{
+				if(std::is_trivially_copyable<T>::value)
+					std::memcpy((void *)&table[to], (void *)entries, sizeof(T) * count);
+				else
+					for(size_t i = 0; i < count; ++i)
+						new (&table[to + i]) T(entries[i]);
+			}
+			
+			void release()
+			{
+				if(table)
+				{
+					destroy(0, _size);
+					allocator.free(table);
+				}
+			}
 
 		public:
 			Vector(size_t initial, typename Allocator::Reference allocator = Allocator::default_reference) : allocator(allocator)
@@ -48,10 +108,14 @@ namespace Prelude
 			}
 			
 			Vector(Vector &&vector) :
+				table(vector.table),
 				allocator(vector.allocator),
 				_size(vector._size),
 				_capacity(vector._capacity)
 			{
+				vector.table = nullptr;
+				vector._size = 0;
+				vector._capacity = 0;
 			}
 			
 			Vector(const Vector &vector) :
@@ -67,8 +131,7 @@ namespace Prelude
 			
 			~Vector()
 			{
-				if(table)
-					allocator.free(table);
+				release();
 			}
 			
 			Vector &operator=(const Vector& other)
@@ -76,21 +139,38 @@ namespace Prelude
 				if(this == &other)
 					return *this;
 				
-				if(table)
-					allocator.free(table);
+				release();
 				
 				initialize_copy(other);
 				
 				return *this;
 			}
 			
-			template<class Bother, template<class, class> class Aother> Vector &operator=(const Vector<T, Bother, Aother>& other)
+			Vector &operator=(Vector &&other)
 			{
 				if(this == &other)
 					return *this;
 				
-				if(table)
-					allocator.free(table);
+				release();
+				
+				table = other.table;
+				allocator = other.allocator.reference();
+				_size = other._size;
+				_capacity = other._capacity;
+				
+				other.table = nullptr;
+				other._size = 0;
+				other._capacity = 0;
+				
+				return *this;
+			}
+			
+			template<class Bother, template<class, class> class Aother> Vector &operator=(const Vector<T, Bother, Aother>& other)
+			{
+				if((void *)this == (void *)&other)
+					return *this;
+				
+				release();
 				
 				initialize_copy(other);
 				
@@ -111,7 +191,22 @@ namespace Prelude
 						}
 						while(_size + num > _capacity);
 
-						table = allocator.reallocate(table, _size, _capacity);
+						if(TriviallyRelocatable<T>::value)
+							table = allocator.reallocate(table, _size, _capacity);
+						else
+						{
+							typename Allocator::Storage old = table;
+							
+							table = allocator.allocate(_capacity);
+							
+							for(size_t i = 0; i < _size; ++i)
+							{
+								new (&table[i]) T(std::move(old[i]));
+								old[i].~T();
+							}
+							
+							allocator.free(old);
+						}
 					}
 					else
 					{
@@ -170,7 +265,7 @@ namespace Prelude
 			{
 				prelude_debug_assert(_size > 0);
 				
-				return &table[_size - 1];
+				return table[_size - 1];
 			}
 			
 			T &operator [](size_t index)
@@ -189,14 +284,11 @@ namespace Prelude
 			
 			void clear()
 			{
+				release();
+				
 				_size = 0;
 				_capacity = 0;
-				
-				if(table)
-				{
-					allocator.free(table);
-					table = nullptr;
-				}
+				table = nullptr;
 			}
 			
 			bool expand_to(size_t size, T filler)
@@ -205,8 +297,8 @@ namespace Prelude
 				{
 					expand(size - _size);
 					
-					for(size_t i = _size; i < size - 1; ++i)
-						table[i] = filler;
+					for(size_t i = _size; i < size; ++i)
+						new (&table[i]) T(filler);
 						
 					_size = size;
 					
@@ -218,14 +310,9 @@ namespace Prelude
 			
 			T shift()
 			{
-				T result = first();
+				T result = std::move(first());
 				
-				for(size_t i = 0; i < _size - 1; ++i)
-					table[i] = table[i + 1];
-				
-				_size -= 1;
-				
-				allocator.null(table[_size]);
+				remove(0);
 
 				return result;
 			}
@@ -235,9 +322,10 @@ namespace Prelude
 				prelude_debug_assert(index < _size);
 				
 				_size -= 1;
+				
+				table[index].~T();
 
-				for(size_t i = index; i < _size; ++i)
-					table[i] = table[i + 1];
+				relocate_range(index, index + 1, _size - index);
 					
 				allocator.null(table[_size]);
 			}
@@ -246,11 +334,9 @@ namespace Prelude
 			{
 				expand(count);
 				
-				for(size_t i = _size; i-- > 0;)
-					table[i + count] = table[i];
+				relocate_range(count, 0, _size);
 
-				for(size_t i = 0; i < count; ++i)
-					table[i] = entries[i];
+				copy_entries(0, entries, count);
 					
 				_size += count;
 			}
@@ -259,8 +345,7 @@ namespace Prelude
 			{
 				expand(count);
 
-				for(size_t i = 0; i < count; ++i)
-					table[_size + i] = entries[i];
+				copy_entries(_size, entries, count);
 				
 				_size += count;
 			}
@@ -271,8 +356,8 @@ namespace Prelude
 				
 				expand(count);
 				
-				for(size_t i = 0; i < count; ++i)
-					table[_size + i] = other[i];
+				if(count)
+					copy_entries(_size, other.raw(), count);
 				
 				_size += count;
 			}
@@ -281,7 +366,20 @@ namespace Prelude
 			{
 				expand(1);
 
-				table[_size++] = entry;
+				new (&table[_size]) T(std::move(entry));
+				
+				_size++;
+			}
+			
+			template<typename... Args> T &emplace(Args&&... args)
+			{
+				expand(1);
+				
+				T *result = new (&table[_size]) T(std::forward<Args>(args)...);
+				
+				_size++;
+				
+				return *result;
 			}
 			
 			T pop()
@@ -290,7 +388,9 @@ namespace Prelude
 				
 				size_t new_size = _size - 1;
 				
-				T result = table[new_size];
+				T result = std::move(table[new_size]);
+				
+				table[new_size].~T();
 				
 				if(new_size == 0)
 				{
@@ -340,13 +440,7 @@ namespace Prelude
 			
 			T *find(T entry)
 			{
-				for(auto i = begin(); i != end(); ++i)
-				{
-					if(*i == entry)
-						return i.position();
-				}
-				
-				return 0;
+				return (T *)Search::find(raw(), _size, entry);
 			}
 			
 			class Iterator
@@ -459,7 +553,7 @@ namespace Prelude
 
 			size_t index_of(Iterator &iter)
 			{
-				return (size_t)(iter.position() - raw()) / sizeof(T);
+				return (size_t)(iter.position() - raw());
 			}
 	};
 };